@@ -0,0 +1,10 @@
+#!/bin/bash
+
+# Compares the --topology report of the captured sysfs tree in test/data against the expected one.
+# Covers region to node mapping (memory blocks and dax target_node) and decoder to memdev links.
+# Run from the repository root after building: ./scripts/check_topology.sh [path/to/CXLStressTester]
+
+BIN=${1:-./build/bin/CXLStressTester}
+
+$BIN --topology --sysfs-root=test/data/sysfs | sed -n '/(Topology)/,$p' | grep '^| ' | sed 's/ from [^:]*:/:/' \
+    | diff -u test/data/topology.expected - && echo "topology OK"
@@ -68,6 +68,10 @@ ret_t AddressList::GenerateAddressList()
 	//
 	uint32_t idx = 0;
 
+	// Regenerating replaces the previous contents
+	delete[] mAddrContents;
+	mAddrContents = 0;
+
 	uint64_t addrNumBlocks = mNumSets * mSetOffsetAddrIncr;
 	// Add an extra block for buffer purposes
 	if (addrNumBlocks) addrNumBlocks += 1;
@@ -137,6 +141,11 @@ uint64_t* AddressList::GetListPtr(void)
 	return (mAddrContents);
 }
 
+uint64_t AddressList::GetAddrStart(void)
+{
+	return (mAddrStart);
+}
+
 uint16_t AddressList::GetNumSets(void)
 {
 	return (mNumSets);
@@ -178,4 +187,5 @@ void AddressList::Print()
 
 AddressList::~AddressList()
 {
+	delete[] mAddrContents;
 }
@@ -38,6 +38,7 @@ class AddressList
 		uint64_t GetSizeRequirements();
 		uint64_t GetEntrySize();
 		uint64_t* GetListPtr(void);
+		uint64_t GetAddrStart();
 		uint16_t GetNumSets();
 		uint64_t GetSetOffsetAddrIncr();
 		uint64_t GetNumAddrIncr();
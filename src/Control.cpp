@@ -0,0 +1,243 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <sstream>
+#include <iomanip>
+#include <regex>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#include "Control.h"
+
+extern "C"
+{
+    #include <poll.h>
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+}
+
+#define CONTROL_LOGGER_ID    60
+// Longest wait between checks of the stop request
+#define CONTROL_POLL_MS      100
+#define CONTROL_LINE_MAX     4096
+
+Control::Control(const std::string& path, std::shared_ptr<Test> test) {
+    this->logger = Logger::build();
+    this->path = path;
+    this->test = test;
+}
+
+Control::~Control() {
+    this->stop();
+}
+
+void Control::start(void) {
+    struct sockaddr_un address = {};
+    if (this->path.size() >= sizeof(address.sun_path)) {
+        this->logger->report_failure("Control socket path " + this->path + " is too long.");
+        exit(0);
+    }
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, this->path.c_str(), sizeof(address.sun_path) - 1);
+
+    unlink(this->path.c_str());
+    this->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (this->listen_fd < 0 || bind(this->listen_fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(this->listen_fd, 1) != 0) {
+        this->logger->report_failure("Unable to listen on " + this->path + ": " + std::string(strerror(errno)) + ".");
+        exit(0);
+    }
+
+    for (auto & [hw_id, generator] : this->test->generators_by_hwid) {
+        this->last_loops[hw_id] = generator->getLoops();
+    }
+    this->last_sample = std::chrono::steady_clock::now();
+    this->running = true;
+    this->worker = std::thread([this] { this->task(); });
+    this->logger->print("Listening on " + this->path + ".", CONTROL_LOGGER_ID);
+}
+
+void Control::stop(void) {
+    this->running = false;
+    if (this->worker.joinable()) {
+        this->worker.join();
+    }
+    if (this->listen_fd >= 0) {
+        close(this->listen_fd);
+        unlink(this->path.c_str());
+        this->listen_fd = -1;
+    }
+}
+
+void Control::wait(void) {
+    bool terminal = true;
+    while (!this->stop_requested) {
+        if (!terminal) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(CONTROL_POLL_MS));
+            continue;
+        }
+        struct pollfd input = {STDIN_FILENO, POLLIN, 0};
+        if (poll(&input, 1, CONTROL_POLL_MS) <= 0) {
+            continue;
+        }
+        char key;
+        terminal = read(STDIN_FILENO, &key, 1) > 0;
+        if (terminal && key == '\n') {
+            return;
+        }
+    }
+}
+
+void Control::task(void) {
+    while (this->running) {
+        struct pollfd listener = {this->listen_fd, POLLIN, 0};
+        if (poll(&listener, 1, CONTROL_POLL_MS) <= 0) {
+            continue;
+        }
+        int client_fd = accept4(this->listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client_fd >= 0) {
+            this->serve(client_fd);
+            close(client_fd);
+        }
+    }
+}
+
+void Control::serve(int client_fd) {
+    std::string pending;
+    char buffer[256];
+    while (this->running) {
+        struct pollfd client = {client_fd, POLLIN, 0};
+        int ready = poll(&client, 1, CONTROL_POLL_MS);
+        if (ready == 0) {
+            continue;
+        }
+        ssize_t count = (ready > 0) ? recv(client_fd, buffer, sizeof(buffer), 0) : -1;
+        if (count <= 0) {
+            return;
+        }
+        pending.append(buffer, count);
+        if (pending.size() > CONTROL_LINE_MAX) {
+            return;
+        }
+        for (std::size_t end; (end = pending.find('\n')) != std::string::npos;) {
+            std::string line = pending.substr(0, end);
+            pending.erase(0, end + 1);
+            line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+            std::string reply = this->handle(line);
+            if (send(client_fd, reply.data(), reply.size(), MSG_NOSIGNAL) < 0) {
+                return;
+            }
+        }
+    }
+}
+
+bool Control::select(const std::string& list, std::vector<std::uint64_t>& hw_ids, std::string& error) {
+    if (list == "all") {
+        for (auto & [hw_id, generator] : this->test->generators_by_hwid) {
+            hw_ids.push_back(hw_id);
+        }
+        return true;
+    }
+    if (!std::regex_match(list, std::regex("\\d+(,\\d+)*"))) {
+        error = "expected hw ids or all, got '" + list + "'";
+        return false;
+    }
+    std::stringstream ss_list(list);
+    for (std::string hw_id; getline(ss_list, hw_id, ',');) {
+        if (this->test->generators_by_hwid.find(std::stoull(hw_id)) == this->test->generators_by_hwid.end()) {
+            error = "no generator with hw id " + hw_id;
+            return false;
+        }
+        hw_ids.push_back(std::stoull(hw_id));
+    }
+    return true;
+}
+
+std::string Control::stats(void) {
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration_cast<std::chrono::nanoseconds>(now - this->last_sample).count() / 1e9;
+    this->last_sample = now;
+
+    std::stringstream ss;
+    ss << std::setw(8) << "hwid" << std::setw(8) << "active" << std::setw(16) << "loops"
+       << std::setw(16) << "MB/s" << std::setw(16) << "Mops/s" << std::setw(16) << "ns/access" << "\n";
+    for (auto & [hw_id, generator] : this->test->generators_by_hwid) {
+        GeneratorSnapshot snapshot = generator->snapshot();
+        uint64_t delta = snapshot.loops - this->last_loops[hw_id];
+        this->last_loops[hw_id] = snapshot.loops;
+        double accesses = (double)delta * generator->getAccessesPerLoop();
+        ss << std::setw(8) << hw_id << std::setw(8) << (snapshot.active ? "yes" : "no") << std::setw(16) << snapshot.loops
+           << std::fixed << std::setprecision(2)
+           << std::setw(16) << ((seconds > 0) ? delta * generator->getBytesPerLoop() / seconds / 1e6 : 0)
+           << std::setw(16) << ((seconds > 0) ? accesses / seconds / 1e6 : 0)
+           << std::setw(16) << ((accesses > 0) ? seconds * 1e9 / accesses : 0) << "\n";
+    }
+    return ss.str();
+}
+
+std::string Control::handle(const std::string& line) {
+    std::stringstream ss_line(line);
+    std::vector<std::string> words;
+    for (std::string word; ss_line >> word;) {
+        words.push_back(word);
+    }
+    if (words.empty()) {
+        return "ok\n";
+    }
+
+    std::string & command = words[0];
+    std::vector<std::uint64_t> hw_ids;
+    std::string error;
+    std::stringstream reply;
+
+    if (command == "list") {
+        for (auto & [hw_id, generator] : this->test->generators_by_hwid) {
+            auto & definition = this->test->threads_define[hw_id];
+            auto cpu_generator = std::dynamic_pointer_cast<CpuTrafficGenerator>(generator);
+            reply << hw_id << " " << definition["type"] << " " << (generator->isActive() ? "active" : "paused")
+                  << " rate=" << (cpu_generator ? cpu_generator->getRate() : 0) << " algorithm=" << definition["algorithm"]
+                  << " pattern=" << definition["pattern"] << " offset=" << definition["offset"] << " size=" << definition["size"] << "\n";
+        }
+    } else if (command == "stats") {
+        reply << this->stats();
+    } else if ((command == "pause" || command == "resume") && words.size() == 2) {
+        if (!this->select(words[1], hw_ids, error)) {
+            return "error: " + error + "\n";
+        }
+        for (auto & hw_id : hw_ids) {
+            this->test->generators_by_hwid[hw_id]->setActive(command == "resume");
+        }
+    } else if (command == "set" && words.size() >= 3) {
+        if (!this->select(words[1], hw_ids, error)) {
+            return "error: " + error + "\n";
+        }
+        std::unordered_map<std::string, std::string> changes;
+        for (std::size_t idx = 2; idx < words.size(); idx++) {
+            std::smatch change;
+            if (!std::regex_match(words[idx], change, std::regex("(pattern)=(0x[0-9a-fA-F]+)|(offset|size|rate)=(\\d+)"))) {
+                return "error: expected pattern=0xhex, offset=dec, size=dec or rate=dec, got '" + words[idx] + "'\n";
+            }
+            changes[change[1].matched ? change[1].str() : change[3].str()] = change[1].matched ? change[2].str() : change[4].str();
+        }
+        for (auto & hw_id : hw_ids) {
+            if (!this->test->reconfigure(hw_id, changes, error)) {
+                return "error: " + error + "\n";
+            }
+        }
+        this->logger->print("Generator(s) " + words[1] + " reconfigured: " + line.substr(line.find(words[2])), CONTROL_LOGGER_ID);
+    } else if (command == "stop") {
+        this->stop_requested = true;
+    } else if (command == "help") {
+        reply << "list | stats | pause <ids|all> | resume <ids|all> | set <ids|all> pattern=0xhex offset=dec size=dec (MulWr) rate=MB/s | stop\n";
+    } else {
+        return "error: unknown command '" + line + "', try help\n";
+    }
+    reply << "ok\n";
+    return reply.str();
+}
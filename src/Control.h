@@ -0,0 +1,75 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <map>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/Logger.h"
+#include "Test.h"
+
+/**
+ * @class Control
+ * @brief Line based UNIX domain socket server driving a running test.
+ * One client is served at a time, every command is answered with zero or more lines followed by
+ * "ok" or "error: <reason>":
+ *   list                               generators with their type, state, rate and algorithm
+ *   stats                              bandwidth of every generator since the previous stats
+ *   pause <hwid,...|all>               idle generators without stopping them
+ *   resume <hwid,...|all>              issue traffic again
+ *   set <hwid,...|all> key=value ...   pattern=0xhex, offset=dec, size=dec, rate=MB/s (0 unthrottled)
+ *   stop                               end the run, like pressing enter
+ * Changes are applied by the generators between iterations, targets stay allocated and warm.
+ */
+class Control {
+   private:
+    std::string path;
+    std::shared_ptr<Test> test;
+    std::shared_ptr<Logger> logger;
+    std::thread worker;
+    std::atomic<bool> running = false;
+    std::atomic<bool> stop_requested = false;
+    int listen_fd = -1;
+
+    std::map<std::uint64_t, std::uint64_t> last_loops;
+    std::chrono::steady_clock::time_point last_sample;
+
+    void task(void);
+    void serve(int client_fd);
+    std::string handle(const std::string& line);
+    bool select(const std::string& list, std::vector<std::uint64_t>& hw_ids, std::string& error);
+    std::string stats(void);
+
+   public:
+    /**
+     * @param path Socket path, an existing socket file is replaced.
+     * @param test Test whose generators are controlled, started already.
+     */
+    Control(const std::string& path, std::shared_ptr<Test> test);
+    ~Control();
+
+    /**
+     * @brief Binds the socket and starts serving it. Exits the test when the socket cannot be bound.
+     */
+    void start(void);
+
+    /**
+     * @brief Stops serving and removes the socket file.
+     */
+    void stop(void);
+
+    /**
+     * @brief Blocks until a client sends stop or enter is pressed. Closed stdin is ignored,
+     * so automation without a terminal only stops through the socket.
+     */
+    void wait(void);
+};
@@ -0,0 +1,251 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <sstream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <regex>
+
+#include "Daemon.h"
+#include "utils/Parser.h"
+
+extern "C"
+{
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+}
+
+#define DAEMON_LOGGER_ID    62
+#define DAEMON_LINE_MAX     4096
+
+static std::uint64_t elapsed_us(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+}
+
+static std::string json_string(const std::string& value) {
+    std::string escaped = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+static bool same_backing(const TargetBacking& a, const TargetBacking& b) {
+    return a.path == b.path && a.page == b.page && a.interleave == b.interleave;
+}
+
+Daemon::Daemon(const std::string& path, std::shared_ptr<CxlTopology> topology) {
+    this->logger = Logger::build();
+    this->path = path;
+    this->topology = topology;
+}
+
+std::shared_ptr<Target> Daemon::lease(std::uint32_t id, std::uint16_t node, const TargetGeometry& extent, const TargetBacking& backing) {
+    auto begin = std::chrono::steady_clock::now();
+    AddressList list(extent.addr_start, extent.num_sets, extent.set_offset_incr, extent.num_addr_incr, (extent.addr_incr << 6));
+    list.GenerateAddressList();
+    std::uint64_t required = list.GetSizeRequirements();
+
+    // Smallest free target of the same node and backing that fits
+    PoolEntry* best = nullptr;
+    for (auto & entry : this->pool) {
+        if (entry.leased || entry.node != node || !same_backing(entry.target->GetBacking(), backing) ||
+            entry.target->GetCapacity() < required) {
+            continue;
+        }
+        if (!best || entry.target->GetCapacity() < best->target->GetCapacity()) {
+            best = &entry;
+        }
+    }
+    if (best) {
+        best->target->Lease(id, extent);
+        best->leased = true;
+        best->submissions++;
+        this->leases.push_back({id, required, true, elapsed_us(begin, std::chrono::steady_clock::now())});
+        return best->target;
+    }
+
+    // Free targets left of this node and backing are all too small, drop them so the pool keeps one per lease
+    for (auto entry = this->pool.begin(); entry != this->pool.end();) {
+        if (entry->leased || entry->node != node || !same_backing(entry->target->GetBacking(), backing)) {
+            entry++;
+            continue;
+        }
+        this->logger->print("Releasing pooled target of " + std::to_string(entry->target->GetCapacity()) + " bytes on node " +
+                            std::to_string(node) + ", " + std::to_string(required) + " bytes needed.", DAEMON_LOGGER_ID);
+        entry->target->Release();
+        entry = this->pool.erase(entry);
+    }
+    auto target = std::make_shared<Target>(id, node, extent.addr_start, extent.num_sets, extent.set_offset_incr,
+                                           extent.num_addr_incr, (extent.addr_incr << 6), backing);
+    this->pool.push_back({target, node, true, 1});
+    this->leases.push_back({id, required, false, elapsed_us(begin, std::chrono::steady_clock::now())});
+    return target;
+}
+
+std::string Daemon::submit(const std::string& file, std::uint64_t run_ms) {
+    if (!std::ifstream(file).good()) {
+        throw std::runtime_error("cannot open " + file);
+    }
+    this->submissions++;
+    this->leases.clear();
+    this->logger->print("Submission " + std::to_string(this->submissions) + ": " + file, DAEMON_LOGGER_ID);
+
+    auto parser = std::make_shared<Parser>();
+    auto test = std::make_shared<Test>();
+    parser->file = file;
+    // --node=cxl and miscompare decoding use the topology read when the daemon started
+    parser->topology = this->topology;
+    test->topology = this->topology;
+    parser->target_factory = [this](std::uint32_t id, std::uint16_t node, const TargetGeometry& extent, const TargetBacking& backing) {
+        return this->lease(id, node, extent, backing);
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+    parser->parse_hammer_file(test->targets, test->threads_define, test->phases);
+    auto targets_ready = std::chrono::steady_clock::now();
+    // Both move target memory around, the pool would hand it out changed
+    if (!parser->sweeps.empty() || !parser->migrations.empty()) {
+        throw std::runtime_error("sweeps and migrations need a cold process");
+    }
+
+    test->perf_counters = parser->perf_counters;
+    test->perf_raw_events = parser->perf_raw_events;
+    test->converge_cv = parser->converge_cv;
+    test->converge_max_ms = parser->converge_max_ms;
+    test->load_generators();
+    test->configure();
+    auto generators_ready = std::chrono::steady_clock::now();
+    // Leased targets are sized to their geometry, only the bytes this submission uses are cleared
+    test->clear_memory();
+    auto cleared = std::chrono::steady_clock::now();
+
+    if (test->phases.empty() && test->converge_cv == 0) {
+        Phase phase = {0, run_ms, {}};
+        for (auto & [hw_id, generator] : test->generators_by_hwid) {
+            phase.threads.push_back(hw_id);
+        }
+        test->phases[0] = phase;
+    }
+    test->start();
+    test->run();
+    test->stop();
+    bool passed = test->verify();
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "{\"submission\": " << this->submissions << ", \"file\": " << json_string(file) << ", \"passed\": " << (passed ? "true" : "false")
+       << ", \"setup_us\": {\"targets\": " << elapsed_us(begin, targets_ready) << ", \"generators\": " << elapsed_us(targets_ready, generators_ready)
+       << ", \"clear\": " << elapsed_us(generators_ready, cleared) << ", \"total\": " << elapsed_us(begin, cleared) << "}, \"targets\": [";
+    for (std::size_t idx = 0; idx < this->leases.size(); idx++) {
+        auto & lease = this->leases[idx];
+        ss << (idx ? ", " : "") << "{\"id\": " << lease.id << ", \"bytes\": " << lease.bytes << ", \"reused\": " << (lease.reused ? "true" : "false")
+           << ", \"setup_us\": " << lease.setup_us << "}";
+    }
+    ss << "], \"phases\": [";
+    for (std::size_t idx = 0; idx < test->phase_stats.size(); idx++) {
+        auto & phase = test->phase_stats[idx];
+        double seconds = phase.elapsed_ns / 1e9;
+        ss << (idx ? ", " : "") << "{\"id\": " << phase.phase_id << ", \"elapsed_ns\": " << phase.elapsed_ns << ", \"generators\": [";
+        for (std::size_t gen = 0; gen < phase.generators.size(); gen++) {
+            auto & generator = phase.generators[gen];
+            ss << (gen ? ", " : "") << "{\"hwid\": " << generator.hw_id << ", \"active\": " << (generator.active ? "true" : "false")
+               << ", \"loops\": " << generator.loops << ", \"mbps\": " << ((seconds > 0) ? generator.bytes / seconds / 1e6 : 0)
+               << ", \"mops\": " << ((seconds > 0) ? generator.accesses / seconds / 1e6 : 0)
+               << ", \"ns_per_access\": " << ((generator.accesses > 0) ? (double)phase.elapsed_ns / generator.accesses : 0) << "}";
+        }
+        ss << "]}";
+    }
+    ss << "]}\n";
+    return ss.str();
+}
+
+std::string Daemon::pool_json(void) {
+    std::stringstream ss;
+    ss << "{\"submissions\": " << this->submissions << ", \"targets\": [";
+    for (std::size_t idx = 0; idx < this->pool.size(); idx++) {
+        auto & entry = this->pool[idx];
+        auto & backing = entry.target->GetBacking();
+        ss << (idx ? ", " : "") << "{\"node\": " << entry.node << ", \"bytes\": " << entry.target->GetCapacity()
+           << ", \"page\": " << json_string(backing.page) << ", \"path\": " << json_string(backing.path)
+           << ", \"interleaved\": " << (backing.interleave.empty() ? "false" : "true") << ", \"submissions\": " << entry.submissions << "}";
+    }
+    ss << "]}\n";
+    return ss.str();
+}
+
+int Daemon::run(void) {
+    struct sockaddr_un address = {};
+    if (this->path.size() >= sizeof(address.sun_path)) {
+        this->logger->report_failure("Daemon socket path " + this->path + " is too long.");
+        exit(0);
+    }
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, this->path.c_str(), sizeof(address.sun_path) - 1);
+
+    unlink(this->path.c_str());
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listen_fd, 4) != 0) {
+        this->logger->report_failure("Unable to listen on " + this->path + ": " + std::string(strerror(errno)) + ".");
+        exit(0);
+    }
+    this->logger->print("Waiting for submissions on " + this->path + ".", DAEMON_LOGGER_ID);
+
+    bool shutdown = false;
+    while (!shutdown) {
+        int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            continue;
+        }
+        std::string pending;
+        char buffer[256];
+        for (ssize_t count; !shutdown && (count = recv(client_fd, buffer, sizeof(buffer), 0)) > 0 && pending.size() <= DAEMON_LINE_MAX;) {
+            pending.append(buffer, count);
+            for (std::size_t end; !shutdown && (end = pending.find('\n')) != std::string::npos;) {
+                std::stringstream ss_line(pending.substr(0, end));
+                pending.erase(0, end + 1);
+                std::string command, file, run_ms, reply;
+                ss_line >> command >> file >> run_ms;
+
+                if (command == "submit" && !file.empty() && (run_ms.empty() || std::regex_match(run_ms, std::regex("\\d+")))) {
+                    try {
+                        reply = this->submit(file, run_ms.empty() ? DAEMON_DEFAULT_RUN_MS : std::stoull(run_ms)) + "ok\n";
+                    } catch (const std::exception& e) {
+                        reply = "error: " + std::string(e.what()) + "\n";
+                    }
+                    for (auto & entry : this->pool) {
+                        entry.leased = false;
+                    }
+                } else if (command == "pool") {
+                    reply = this->pool_json() + "ok\n";
+                } else if (command == "shutdown") {
+                    reply = "ok\n";
+                    shutdown = true;
+                } else if (command.empty()) {
+                    reply = "ok\n";
+                } else {
+                    reply = "error: expected submit <file.hammer> [run_ms], pool or shutdown\n";
+                }
+                if (send(client_fd, reply.data(), reply.size(), MSG_NOSIGNAL) < 0) {
+                    break;
+                }
+            }
+        }
+        close(client_fd);
+    }
+
+    close(listen_fd);
+    unlink(this->path.c_str());
+    this->logger->print("Shutting down with " + std::to_string(this->pool.size()) + " pooled targets after " +
+                        std::to_string(this->submissions) + " submissions.", DAEMON_LOGGER_ID);
+    return 0;
+}
@@ -0,0 +1,77 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utils/Logger.h"
+#include "Target.h"
+#include "Test.h"
+#include "cxl/CxlTopology.h"
+
+// Run length of a submission whose hammer file defines no phase
+#define DAEMON_DEFAULT_RUN_MS    2000
+
+/**
+ * @brief Target kept allocated by the daemon between submissions.
+ * Targets are reused for the same node and backing (page size, file, interleave) when large enough,
+ * free ones too small are released when a larger one is allocated, so the pool stays bounded.
+ */
+typedef struct {
+    std::shared_ptr<Target> target;
+    std::uint16_t node;
+    bool leased;
+    std::uint64_t submissions;
+} PoolEntry;
+
+/**
+ * @class Daemon
+ * @brief Keeps targets allocated, touched and locked across hammer file submissions on a UNIX socket.
+ * Commands, answered with zero or more lines followed by "ok" or "error: <reason>":
+ *   submit <file.hammer> [run_ms]   run a hammer file on pooled targets, one JSON line of results
+ *   pool                            targets held, one JSON line
+ *   shutdown                        release the pool and exit
+ * A submission only rebuilds address lists and generators and clears the bytes its geometry uses.
+ * Hammer files are checked like in a cold run, errors that end a cold run end the daemon too.
+ */
+class Daemon {
+   private:
+    std::string path;
+    std::shared_ptr<Logger> logger;
+    std::vector<PoolEntry> pool;
+    std::uint64_t submissions = 0;
+    /* Read once at start, every submission decodes against it. */
+    std::shared_ptr<CxlTopology> topology;
+
+    /* Setup of the targets of the running submission, in build order. */
+    struct Lease {
+        std::uint32_t id;
+        std::uint64_t bytes;
+        bool reused;
+        std::uint64_t setup_us;
+    };
+    std::vector<Lease> leases;
+
+    std::shared_ptr<Target> lease(std::uint32_t id, std::uint16_t node, const TargetGeometry& extent, const TargetBacking& backing);
+    std::string submit(const std::string& file, std::uint64_t run_ms);
+    std::string pool_json(void);
+
+   public:
+    /**
+     * @param path Socket path, an existing socket file is replaced.
+     * @param topology CXL topology discovered under the --sysfs-root of the daemon command line.
+     */
+    Daemon(const std::string& path, std::shared_ptr<CxlTopology> topology);
+
+    /**
+     * @brief Serves submissions one at a time until shutdown. Exits the test when the socket cannot be bound.
+     * @return 0 once shut down.
+     */
+    int run(void);
+};
@@ -0,0 +1,140 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <cstring>
+#include <exception>
+#include <pthread.h>
+#include <sched.h>
+
+#include "Executor.h"
+
+#define EXECUTOR_LOGGER_ID    200
+
+Executor::Executor() {
+    this->logger = Logger::build();
+    this->gate = std::make_shared<Gate>();
+}
+
+Executor::~Executor() {
+    this->release();
+    this->join(std::chrono::milliseconds(EXECUTOR_JOIN_TIMEOUT_MS));
+}
+
+void Executor::spawn(std::uint64_t hw_id, std::shared_ptr<ITrafficGenerator> generator, std::int64_t cpu) {
+    auto begin = std::chrono::steady_clock::now();
+    Worker worker;
+    worker.hw_id = hw_id;
+    worker.generator = generator;
+
+    std::promise<ret_t> promise;
+    worker.result = promise.get_future();
+    std::size_t index = this->workers.size();
+    {
+        std::lock_guard<std::mutex> lock(this->gate->mutex);
+        this->gate->runnable.push_back(false);
+    }
+
+    // Generator and gate are captured by value, the worker owns everything it touches
+    worker.thread = std::thread([gate = this->gate, generator, index, promise = std::move(promise)]() mutable {
+        {
+            std::unique_lock<std::mutex> lock(gate->mutex);
+            gate->released_cv.wait(lock, [&] { return gate->released; });
+            if (!gate->runnable[index]) {
+                promise.set_value(0);
+                return;
+            }
+        }
+        try {
+            promise.set_value(generator->task());
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    });
+
+    if (cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        int ret = pthread_setaffinity_np(worker.thread.native_handle(), sizeof(cpu_set_t), &cpus);
+        if (ret != 0) {
+            worker.setup_code = -1;
+            worker.setup_error = "unable to pin to cpu " + std::to_string(cpu) + ": " + std::string(strerror(ret));
+        }
+    }
+    this->workers.push_back(std::move(worker));
+    this->spawn_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void Executor::launch(void) {
+    auto begin = std::chrono::steady_clock::now();
+    for (auto & worker : this->workers) {
+        if (worker.setup_code != 0) continue;
+        ret_t code = worker.generator->configure();
+        if (code != 0) {
+            worker.setup_code = code;
+            worker.setup_error = "configure returned " + std::to_string(code);
+        }
+    }
+    auto configure_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+
+    {
+        std::lock_guard<std::mutex> lock(this->gate->mutex);
+        for (std::size_t idx = 0; idx < this->workers.size(); idx++) {
+            this->gate->runnable[idx] = (this->workers[idx].setup_code == 0);
+        }
+        this->gate->released = true;
+    }
+    this->gate->released_cv.notify_all();
+    this->logger->print(std::to_string(this->workers.size()) + " generator threads pinned in " + std::to_string(this->spawn_ns / 1000) +
+                        " us, configured in " + std::to_string(configure_us) + " us.", EXECUTOR_LOGGER_ID);
+}
+
+void Executor::release(void) {
+    {
+        std::lock_guard<std::mutex> lock(this->gate->mutex);
+        this->gate->released = true;
+    }
+    this->gate->released_cv.notify_all();
+}
+
+std::vector<ExecutorResult> Executor::join(std::chrono::milliseconds timeout) {
+    // Workers never launched leave without running their task
+    this->release();
+
+    std::vector<ExecutorResult> results;
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (auto & worker : this->workers) {
+        ExecutorResult result = {worker.hw_id, worker.setup_code, false, worker.setup_error};
+        if (!worker.thread.joinable()) {
+            continue;
+        }
+        if (worker.result.wait_until(deadline) != std::future_status::ready) {
+            // A stuck task cannot be joined, its thread holds its own generator reference
+            worker.thread.detach();
+            result.code = -1;
+            result.timed_out = true;
+            result.error = "task did not return within " + std::to_string(timeout.count()) + " ms";
+            results.push_back(result);
+            continue;
+        }
+        worker.thread.join();
+        try {
+            ret_t code = worker.result.get();
+            if (result.code == 0) {
+                result.code = code;
+            }
+        } catch (const std::exception& e) {
+            result.code = -1;
+            result.error = e.what();
+        } catch (...) {
+            result.code = -1;
+            result.error = "unknown exception";
+        }
+        results.push_back(result);
+    }
+    return results;
+}
@@ -0,0 +1,96 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#include "generator/ITrafficGenerator.h"
+#include "utils/Logger.h"
+
+// Longest wait for generator tasks to return once stopped
+#define EXECUTOR_JOIN_TIMEOUT_MS    10000
+
+/**
+ * @brief Outcome of a generator task. code is the task return value, or the failing configure()
+ * return value, -1 when the task threw, could not be pinned or did not return in time.
+ */
+typedef struct {
+    std::uint64_t hw_id;
+    ret_t code;
+    bool timed_out;
+    std::string error;
+} ExecutorResult;
+
+/**
+ * @class Executor
+ * @brief Runs generator tasks on dedicated threads.
+ * Threads are created and pinned up front and park until launch(), which configures every generator
+ * from the calling thread before releasing them all at once. Return codes and exceptions are kept
+ * for join(), which gives up on tasks that do not return before its deadline.
+ */
+class Executor {
+   private:
+    /* Shared with the workers, so a detached worker never outlives what it waits on. */
+    struct Gate {
+        std::mutex mutex;
+        std::condition_variable released_cv;
+        bool released = false;
+        std::vector<bool> runnable;
+    };
+
+    struct Worker {
+        std::uint64_t hw_id;
+        std::shared_ptr<ITrafficGenerator> generator;
+        std::thread thread;
+        std::future<ret_t> result;
+        ret_t setup_code = 0;
+        std::string setup_error;
+    };
+
+    std::shared_ptr<Gate> gate;
+    std::vector<Worker> workers;
+    std::shared_ptr<Logger> logger;
+    std::uint64_t spawn_ns = 0;
+
+    void release(void);
+
+   public:
+    Executor();
+
+    /**
+     * @brief Releases parked workers without running them and waits for running ones.
+     */
+    ~Executor();
+
+    /**
+     * @brief Creates the thread of a generator, parked until launch().
+     * @param hw_id Hw id of the generator in hammer file.
+     * @param generator Generator whose task() the thread runs, the thread keeps its own reference.
+     * @param cpu Cpu the thread is pinned to, negative leaves it unpinned (device generators).
+     */
+    void spawn(std::uint64_t hw_id, std::shared_ptr<ITrafficGenerator> generator, std::int64_t cpu);
+
+    /**
+     * @brief Configures every generator in spawn order, then releases all workers into their task.
+     * Workers whose pinning or configuration failed do not run.
+     */
+    void launch(void);
+
+    /**
+     * @brief Waits for every task until the deadline. Tasks still running then are detached and reported.
+     * @param timeout Deadline for all tasks together.
+     * @return One result per spawned generator, in spawn order.
+     */
+    std::vector<ExecutorResult> join(std::chrono::milliseconds timeout);
+};
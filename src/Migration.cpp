@@ -0,0 +1,267 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
+
+#include "Migration.h"
+#include "cxl/CxlAddressMap.h"
+
+extern "C"
+{
+    #include <numaif.h>
+}
+
+#define MIGRATION_LOGGER_ID    58
+// Longest sleep between checks of the stop request
+#define MIGRATION_POLL_MS      10
+// Longest wait for generators to idle before a verified batch, the batch moves unverified past it
+#define MIGRATION_HOLD_TIMEOUT_MS    100
+
+Migration::Migration(const MigrationDefinition& definition, std::shared_ptr<Target> target,
+                     const std::map<std::uint64_t, std::shared_ptr<ITrafficGenerator>>& generators) {
+    this->logger = Logger::build();
+    this->definition = definition;
+    this->target = target;
+    this->generators = generators;
+
+    // Every 1/fraction-th page migrates, so generators sweeping the target keep running into moving pages
+    uint64_t page_size = target->GetPageSize();
+    uint64_t total = (target->size + page_size - 1) / page_size;
+    uint64_t count = std::max<uint64_t>(1, (uint64_t)(total * definition.fraction));
+    for (uint64_t idx = 0; idx < count; idx++) {
+        this->pages.push_back((void*)(target->address + (uint64_t)(idx / definition.fraction) * page_size));
+    }
+    if (definition.verify) {
+        this->shadow.resize(std::max<uint64_t>(1, MIGRATION_BATCH_BYTES / page_size) * page_size);
+    }
+}
+
+Migration::~Migration() {
+    this->stop();
+}
+
+void Migration::start(void) {
+    this->running = true;
+    this->worker = std::thread([this] { this->task(); });
+}
+
+void Migration::stop(void) {
+    this->running = false;
+    if (this->worker.joinable()) {
+        this->worker.join();
+    }
+}
+
+std::map<std::uint64_t, std::uint64_t> Migration::sample_loops(void) {
+    std::map<std::uint64_t, std::uint64_t> loops;
+    for (auto & [hw_id, generator] : this->generators) {
+        GeneratorSnapshot snapshot = generator->snapshot();
+        if (snapshot.active) {
+            loops[hw_id] = snapshot.loops;
+        }
+    }
+    return loops;
+}
+
+void Migration::task(void) {
+    bool moving = true;
+    auto window_begin = std::chrono::steady_clock::now();
+    auto loops = this->sample_loops();
+
+    while (this->running) {
+        auto window_end = window_begin + std::chrono::milliseconds(moving ? this->definition.on_ms : this->definition.off_ms);
+        if (moving) {
+            this->burst(window_end);
+            this->bursts++;
+        } else {
+            while (this->running && std::chrono::steady_clock::now() < window_end) {
+                std::this_thread::sleep_until(std::min(window_end, std::chrono::steady_clock::now() + std::chrono::milliseconds(MIGRATION_POLL_MS)));
+            }
+        }
+
+        // Generators idled by a phase change during the window are left out
+        auto now = std::chrono::steady_clock::now();
+        auto window_loops = this->sample_loops();
+        uint64_t window_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - window_begin).count();
+        for (auto & [hw_id, count] : window_loops) {
+            if (loops.find(hw_id) == loops.end()) continue;
+            auto & window = this->windows[hw_id];
+            (moving ? window.loops_moving : window.loops_idle) += count - loops[hw_id];
+            (moving ? window.ns_moving : window.ns_idle) += window_ns;
+        }
+        if (moving) {
+            this->moving_ns += window_ns;
+        }
+        window_begin = now;
+        loops = window_loops;
+        moving = !moving || (this->definition.off_ms == 0);
+    }
+}
+
+void Migration::burst(std::chrono::steady_clock::time_point end) {
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t batch = std::max<uint64_t>(1, MIGRATION_BATCH_BYTES / this->target->GetPageSize());
+    uint64_t moved = 0;
+
+    while (this->running && std::chrono::steady_clock::now() < end) {
+        std::size_t count = std::min<std::size_t>(batch, this->pages.size() - this->cursor);
+        this->move_batch(this->cursor, count);
+        this->cursor = (this->cursor + count) % this->pages.size();
+        moved += count;
+
+        if (this->definition.rate > 0) {
+            // Pace to the rate over the whole burst, a slow batch is caught up by the next ones
+            auto due = begin + std::chrono::nanoseconds(moved * 1000000000ULL / this->definition.rate);
+            while (this->running && std::chrono::steady_clock::now() < std::min(due, end)) {
+                std::this_thread::sleep_until(std::min({due, end, std::chrono::steady_clock::now() + std::chrono::milliseconds(MIGRATION_POLL_MS)}));
+            }
+        }
+    }
+}
+
+bool Migration::hold_generators(void) {
+    for (auto & [hw_id, generator] : this->generators) {
+        generator->hold(true);
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(MIGRATION_HOLD_TIMEOUT_MS);
+    for (auto & [hw_id, generator] : this->generators) {
+        while (!generator->isHeld()) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    return true;
+}
+
+void Migration::release_generators(void) {
+    for (auto & [hw_id, generator] : this->generators) {
+        generator->hold(false);
+    }
+}
+
+void Migration::move_batch(std::size_t first, std::size_t count) {
+    std::vector<int> nodes(count), status(count);
+    uint64_t page_size = this->target->GetPageSize();
+    void** batch = this->pages.data() + first;
+
+    // With writers held any line differing after the move was changed by the move itself
+    bool verifying = false;
+    if (this->definition.verify) {
+        verifying = this->hold_generators();
+        if (!verifying) {
+            this->unverified_batches++;
+        }
+    }
+
+    // Each page goes to whichever node of the pair it is not on
+    if (move_pages(0, count, batch, nullptr, status.data(), 0) != 0) {
+        this->last_error = errno;
+        this->pages_failed += count;
+        if (this->definition.verify) {
+            this->release_generators();
+        }
+        return;
+    }
+    for (std::size_t idx = 0; idx < count; idx++) {
+        nodes[idx] = (status[idx] == this->definition.nodes[0]) ? this->definition.nodes[1] : this->definition.nodes[0];
+    }
+    if (verifying) {
+        for (std::size_t idx = 0; idx < count; idx++) {
+            memcpy(this->shadow.data() + idx * page_size, batch[idx], page_size);
+        }
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    long ret = move_pages(0, count, batch, nodes.data(), status.data(), MPOL_MF_MOVE);
+    this->move_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+    if (ret < 0) {
+        this->last_error = errno;
+    }
+    std::vector<uint64_t> moved;
+    for (std::size_t idx = 0; idx < count; idx++) {
+        if (ret >= 0 && status[idx] == nodes[idx]) {
+            this->pages_moved++;
+            moved.push_back((uint64_t)batch[idx]);
+        } else {
+            this->pages_failed++;
+        }
+    }
+    // Moved pages changed physical address, miscompare reports must decode the new one
+    if (!moved.empty()) {
+        CxlAddressMap::build()->refresh(moved, page_size);
+    }
+
+    if (verifying) {
+        for (std::size_t idx = 0; idx < count; idx++) {
+            for (uint64_t line = 0; line < page_size; line += CACHELINE_SIZE) {
+                if (memcmp(this->shadow.data() + idx * page_size + line, (uint8_t*)batch[idx] + line, CACHELINE_SIZE) != 0) {
+                    this->corrupted_lines++;
+                }
+            }
+        }
+    }
+    if (this->definition.verify) {
+        this->release_generators();
+    }
+}
+
+void Migration::print(void) {
+    std::stringstream ss;
+    double moving_s = this->moving_ns / 1e9;
+    double bytes = (double)this->pages_moved * this->target->GetPageSize();
+    ss << std::fixed << std::setprecision(2) << "Target " << this->definition.target << " between nodes " << this->definition.nodes[0]
+       << " and " << this->definition.nodes[1] << ": " << this->pages_moved << " pages moved, " << this->pages_failed
+       << " failed, " << this->bursts << " bursts, " << ((moving_s > 0) ? this->pages_moved / moving_s : 0) << " pages/s, "
+       << ((moving_s > 0) ? bytes / moving_s / 1e9 : 0) << " GB/s ("
+       << ((this->move_ns > 0) ? bytes / this->move_ns : 0) << " GB/s inside move_pages).";
+    this->logger->print(ss.str(), MIGRATION_LOGGER_ID);
+    if (this->last_error != 0) {
+        this->logger->report_failure("move_pages failed: " + std::string(strerror(this->last_error)) + ".");
+    }
+    ss.str(std::string());
+    if (this->definition.verify) {
+        // Generators were held during verified batches, the throughput windows include those pauses
+        ss << "Verify: " << this->corrupted_lines << " lines corrupted across moves, " << this->unverified_batches
+           << " batch(es) moved unverified (generators not idle within " << MIGRATION_HOLD_TIMEOUT_MS << " ms).";
+    } else {
+        ss << "Verify: off.";
+    }
+    this->logger->print(ss.str(), MIGRATION_LOGGER_ID);
+    if (this->corrupted_lines != 0) {
+        this->logger->report_failure("Page migration of target " + std::to_string(this->definition.target) + " corrupted " +
+                                     std::to_string(this->corrupted_lines) + " cache line(s).");
+    }
+
+    ss.str(std::string());
+    ss << "| " << std::setw(8) << "hwid" << std::setw(16) << "MB/s moving" << std::setw(16) << "MB/s idle"
+       << std::setw(16) << "ns/acc moving" << std::setw(16) << "ns/acc idle" << std::setw(10) << "dip %";
+    this->logger->print(ss.str(), 2);
+    for (auto & [hw_id, window] : this->windows) {
+        auto & generator = this->generators[hw_id];
+        double rate_moving = (window.ns_moving > 0) ? (double)window.loops_moving / window.ns_moving : 0;
+        double rate_idle = (window.ns_idle > 0) ? (double)window.loops_idle / window.ns_idle : 0;
+        double accesses = generator->getAccessesPerLoop();
+        ss.str(std::string());
+        ss << std::fixed << std::setprecision(2) << "| " << std::setw(8) << hw_id
+           << std::setw(16) << rate_moving * generator->getBytesPerLoop() * 1e3
+           << std::setw(16) << rate_idle * generator->getBytesPerLoop() * 1e3
+           << std::setw(16) << ((rate_moving > 0 && accesses > 0) ? 1 / (rate_moving * accesses) : 0)
+           << std::setw(16) << ((rate_idle > 0 && accesses > 0) ? 1 / (rate_idle * accesses) : 0)
+           << std::setw(10) << ((rate_idle > 0) ? (1 - rate_moving / rate_idle) * 100 : 0);
+        this->logger->print(ss.str(), 2);
+    }
+}
+
+uint64_t Migration::get_corrupted_lines(void) {
+    return this->corrupted_lines;
+}
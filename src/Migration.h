@@ -0,0 +1,101 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <map>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <vector>
+
+#include "generator/ITrafficGenerator.h"
+#include "utils/Logger.h"
+#include "Target.h"
+#include "TestTypes.h"
+
+// Bytes handed to a single move_pages() call
+#define MIGRATION_BATCH_BYTES    0x40000
+
+/**
+ * @brief Loops a generator completed while pages were moving and while they were not.
+ */
+typedef struct {
+    std::uint64_t loops_moving = 0;
+    std::uint64_t ns_moving = 0;
+    std::uint64_t loops_idle = 0;
+    std::uint64_t ns_idle = 0;
+} MigrationWindows;
+
+/**
+ * @class Migration
+ * @brief Moves pages of a target back and forth between two nodes with move_pages() while generators run.
+ * Migrating pages are spread evenly over the target. Generator loops are sampled at every burst edge
+ * so their throughput with and without migration can be compared.
+ * With verify, generators are held while each batch moves so its pages can be compared before and after.
+ */
+class Migration {
+   private:
+    MigrationDefinition definition;
+    std::shared_ptr<Target> target;
+    std::map<std::uint64_t, std::shared_ptr<ITrafficGenerator>> generators;
+    std::shared_ptr<Logger> logger;
+    std::thread worker;
+    std::atomic<bool> running = false;
+
+    std::vector<void*> pages;
+    std::size_t cursor = 0;
+    std::vector<std::uint8_t> shadow;
+
+    std::uint64_t pages_moved = 0;
+    std::uint64_t pages_failed = 0;
+    std::uint64_t corrupted_lines = 0;
+    std::uint64_t unverified_batches = 0;
+    std::uint64_t move_ns = 0;
+    std::uint64_t moving_ns = 0;
+    std::uint64_t bursts = 0;
+    int last_error = 0;
+    std::map<std::uint64_t, MigrationWindows> windows;
+
+    void task(void);
+    void burst(std::chrono::steady_clock::time_point end);
+    void move_batch(std::size_t first, std::size_t count);
+    /* Holds every generator and waits for them to idle, false if one did not in time (the holds stay, release them). */
+    bool hold_generators(void);
+    void release_generators(void);
+    std::map<std::uint64_t, std::uint64_t> sample_loops(void);
+
+   public:
+    /**
+     * @param definition Migration block of the hammer file.
+     * @param target Target whose pages move.
+     * @param generators Generators whose throughput is compared, by hw id.
+     */
+    Migration(const MigrationDefinition& definition, std::shared_ptr<Target> target,
+              const std::map<std::uint64_t, std::shared_ptr<ITrafficGenerator>>& generators);
+    ~Migration();
+
+    /**
+     * @brief Starts the migration thread.
+     */
+    void start(void);
+
+    /**
+     * @brief Stops the migration thread at the next batch boundary and waits for it.
+     */
+    void stop(void);
+
+    /**
+     * @brief Prints migration throughput, verification and the throughput and latency dip of every generator.
+     */
+    void print(void);
+
+    /**
+     * @return Cache lines whose content changed across a verified move, any is a test failure.
+     */
+    std::uint64_t get_corrupted_lines(void);
+};
@@ -8,7 +8,15 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <sys/sysmacros.h>
 
 #include "Target.h"
 #include "AddressList.h"
@@ -18,7 +26,22 @@
 #define MAP_HUGE_MASK 0x3f
 #define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
 #define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#define HUGE_2MB               0x200000ULL
+#define HUGE_1GB               0x40000000ULL
 #define TARGET_LOGGER_ID       100
+#define HUGETLBFS_MAGIC        0x958458f6
+#define DEVDAX_DEFAULT_ALIGN   0x200000
+#define INTERLEAVE_BATCH_PAGES 0x1000
+#define WEIGHTED_INTERLEAVE_SYSFS "/sys/kernel/mm/mempolicy/weighted_interleave/node"
+#ifndef MPOL_WEIGHTED_INTERLEAVE
+#define MPOL_WEIGHTED_INTERLEAVE 6
+#endif
+#ifndef MAP_SHARED_VALIDATE
+#define MAP_SHARED_VALIDATE    0x03
+#endif
+#ifndef MAP_SYNC
+#define MAP_SYNC               0x80000
+#endif
 
 extern "C"
 {
@@ -44,12 +67,13 @@ Target::Target(uint32_t id, uint16_t node_id)
 
 Target::Target(uint32_t id, uint16_t node_id,
                 uint64_t addrStart, uint16_t numSets, uint64_t setOffsetAddrIncr,
-                uint16_t numAddrIncr, uint64_t addrIncr)
+                uint16_t numAddrIncr, uint64_t addrIncr, const TargetBacking& backing)
 {
     mLogger = Logger::build();
     mLogger->print("Building new target.", TARGET_LOGGER_ID);
 	mID = id;
 	mNodeID = node_id;
+	mBacking = backing;
 	mAddrList = std::make_shared<AddressList>(addrStart, numSets, setOffsetAddrIncr,
 			numAddrIncr, addrIncr);
 
@@ -57,10 +81,16 @@ Target::Target(uint32_t id, uint16_t node_id,
     mrequiredSize = mAddrList->GetSizeRequirements();
     mLogger->print("Required size is estimated to " + std::to_string(mrequiredSize) + " bytes.", TARGET_LOGGER_ID);
 
-    uint64_t allocatedRegion = AllocateMemory(mrequiredSize);
+    // Page size is picked from the target size, set it first
+    this->size = mrequiredSize;
+    auto setupBegin = std::chrono::steady_clock::now();
+    uint64_t allocatedRegion = mBacking.path.empty() ? AllocateMemory(mrequiredSize) : MapFile(mBacking.path, mrequiredSize);
+    auto setupTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - setupBegin);
+    mLogger->print("Setup of " + (mBacking.path.empty() ? std::string("anonymous memory") : mBacking.path) +
+                   " took " + std::to_string(setupTime.count()) + " us.", TARGET_LOGGER_ID);
     // Allocate in public target members
     this->address = allocatedRegion;
-    this->size = mrequiredSize;
+    mCapacity = mrequiredSize;
     std::stringstream ss;
     ss << "Allocated region starts at address 0x" << std::hex << allocatedRegion;
     mLogger->print(ss.str(), TARGET_LOGGER_ID);
@@ -83,15 +113,84 @@ uint64_t Target::operator[] (int index)
     }
 }
 
+uint32_t Target::GetID()
+{
+	return mID;
+}
+
+uint16_t Target::GetNodeID()
+{
+	return mNodeID;
+}
+
 std::shared_ptr<AddressList> Target::GetAddressList()
 {
 	return mAddrList;
 }
 
+void Target::Reshape(const TargetGeometry& geometry)
+{
+    auto addrList = std::make_shared<AddressList>(geometry.addr_start, geometry.num_sets, geometry.set_offset_incr,
+                                                  geometry.num_addr_incr, (geometry.addr_incr << 6));
+    addrList->GenerateAddressList();
+    if (addrList->GetSizeRequirements() > mCapacity) {
+        mLogger->report_failure("Target " + std::to_string(mID) + " geometry needs " + std::to_string(addrList->GetSizeRequirements()) +
+                                " bytes, only " + std::to_string(mCapacity) + " are allocated.");
+        exit(0);
+    }
+    // Requirement is only meaningful before rebasing, generators holding the previous list keep it alive
+    mrequiredSize = addrList->GetSizeRequirements();
+    addrList->RebaseAddressList(this->address);
+    mAddrList = addrList;
+}
+
+void Target::Lease(uint32_t id, const TargetGeometry& geometry)
+{
+    mID = id;
+    Reshape(geometry);
+    this->size = mrequiredSize;
+}
 
-uint64_t Target::AllocateMemory(uint64_t size)
+void Target::Release()
+{
+	if (this->address != 0) {
+		munmap((void*)this->address, mMapSize);
+	}
+	this->address = 0;
+	mCapacity = 0;
+}
+
+uint64_t Target::GetCapacity()
+{
+    return mCapacity;
+}
+
+const TargetBacking& Target::GetBacking()
+{
+    return mBacking;
+}
+
+bool Target::SetGeometry(TargetGeometry& geometry, const std::string& name, const std::string& value)
+{
+    if (name == "addr-start") {
+        geometry.addr_start = std::stoull(value, nullptr, 16);
+    } else if (name == "num-sets") {
+        geometry.num_sets = std::stoull(value);
+    } else if (name == "set-offset-incr") {
+        geometry.set_offset_incr = std::stoull(value, nullptr, 16);
+    } else if (name == "num-addr-incr") {
+        geometry.num_addr_incr = std::stoull(value);
+    } else if (name == "addr-incr") {
+        geometry.addr_incr = std::stoull(value, nullptr, 16);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+
+void Target::BindNode(void)
 {
-	void* LogicalAddressCopy = (void*)-1; //Initializing the value do solve a Coverity scan issue
 	nodemask_t tMask;
 	numa_set_strict(1);
 	nodemask_zero(&tMask);
@@ -109,14 +208,48 @@ uint64_t Target::AllocateMemory(uint64_t size)
         exit(0);
     }
 	numa_set_membind_compat(&tMask);
+}
+
+uint64_t Target::AllocateMemory(uint64_t size)
+{
+	void* LogicalAddressCopy = (void*)-1; //Initializing the value do solve a Coverity scan issue
 
-	if (size <= 0x200000)
+	BindNode();
+
+	if (!HugePagesAvailable(mNodeID, mBacking.page, size))
+	{
+		mLogger->report_failure("Node " + std::to_string(mNodeID) + " lacks free " + mBacking.page + " huge pages for " + std::to_string(size) +
+								" bytes of target " + std::to_string(mID) + ".\nExiting Test ...\n");
+		exit(0);
+	}
+	if (mBacking.page == "4k" || mBacking.page == "thp")
+	{
+		LogicalAddressCopy = MapAnonymous(size, mBacking.page == "thp");
+	} else if (mBacking.page == "2m")
+	{
+		mMapSize = (size + HUGE_2MB - 1) & ~(HUGE_2MB - 1);
+		LogicalAddressCopy = mmap(0, mMapSize, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_NORESERVE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB,
+				-1, 0);
+	} else if (mBacking.page == "1g")
+	{
+		mMapSize = (size + HUGE_1GB - 1) & ~(HUGE_1GB - 1);
+		LogicalAddressCopy = mmap(0, mMapSize, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_NORESERVE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_1GB,
+				-1, 0);
+	} else if (!mBacking.page.empty())
+	{
+		mLogger->report_failure("Unsupported page size " + mBacking.page + ", use 4k, thp, 2m or 1g.");
+		exit(0);
+	} else if (size <= 0x200000)
 	{
+		mMapSize = HUGE_2MB;
 		LogicalAddressCopy = mmap(0, size, PROT_READ | PROT_WRITE, 
 				MAP_PRIVATE | MAP_NORESERVE | MAP_ANONYMOUS | MAP_HUGETLB, 
 				-1, 0);
 	} else if ((size > 0x200000) && (size <= 0x40000000))
 	{
+		mMapSize = HUGE_1GB;
 		LogicalAddressCopy = mmap(0, size, PROT_READ | PROT_WRITE,
 				MAP_PRIVATE | MAP_NORESERVE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_1GB,
 				-1, 0);
@@ -131,9 +264,351 @@ uint64_t Target::AllocateMemory(uint64_t size)
                                 "\nExiting Test ...\n");
         exit(0);
 	}
+	// Kernel policy must be in place before the first touch, explicit placement moves touched pages
+	uint64_t pageSize = GetPageSize();
+	uint64_t placedSize = (size + pageSize - 1) & ~(pageSize - 1);
+	bool kernelPolicy = !mBacking.interleave.empty() && WeightedInterleave(LogicalAddressCopy, placedSize);
 	TouchPages((uint64_t)LogicalAddressCopy,size);
+	if (!mBacking.interleave.empty()) {
+		if (!kernelPolicy) {
+			PlacePages((uint64_t)LogicalAddressCopy, placedSize);
+		}
+		RecordPlacement((uint64_t)LogicalAddressCopy, placedSize);
+	}
     mlock((const void*)LogicalAddressCopy,(size_t)(size));
 
+	if (mBacking.page == "thp") {
+		// khugepaged or a full fault path may leave part of the range on 4 KB pages
+		mLogger->print("THP backs " + std::to_string(AnonHugeBytes((uint64_t)LogicalAddressCopy)) + " of " +
+					   std::to_string(mMapSize) + " bytes.", TARGET_LOGGER_ID);
+	}
+
+	return (uint64_t)LogicalAddressCopy;
+}
+
+bool Target::WeightedInterleave(void* address, uint64_t size)
+{
+	// Kernel weights are system wide, only rely on them when they already are the requested ones
+	for (auto & [node, weight] : mBacking.interleave) {
+		std::ifstream weightFile(WEIGHTED_INTERLEAVE_SYSFS + std::to_string(node));
+		uint64_t kernelWeight = 0;
+		if (!(weightFile >> kernelWeight) || kernelWeight != weight) {
+			return false;
+		}
+	}
+
+	struct bitmask* nodes = numa_allocate_nodemask();
+	for (auto & [node, weight] : mBacking.interleave) {
+		numa_bitmask_setbit(nodes, node);
+	}
+	long ret = mbind(address, size, MPOL_WEIGHTED_INTERLEAVE, nodes->maskp, nodes->size + 1, 0);
+	numa_free_nodemask(nodes);
+	if (ret != 0) {
+		return false;
+	}
+	mPlacementPolicy = "kernel weighted interleave";
+	return true;
+}
+
+void Target::PlacePages(uint64_t address, uint64_t size)
+{
+	uint64_t pageSize = GetPageSize();
+	uint64_t pages = size / pageSize;
+	uint64_t total = 0, failed = 0;
+	int error = 0;
+	for (auto & [node, weight] : mBacking.interleave) {
+		total += weight;
+	}
+
+	std::map<uint16_t, int64_t> current;
+	std::vector<void*> batch;
+	std::vector<int> nodes, status;
+	for (uint64_t page = 0; page < pages; page++) {
+		// Smooth weighted round robin, 3:1 gives A A B A A A B A ...
+		uint16_t best = mBacking.interleave.begin()->first;
+		for (auto & [node, weight] : mBacking.interleave) {
+			current[node] += weight;
+			if (current[node] > current[best]) best = node;
+		}
+		current[best] -= total;
+		batch.push_back((void*)(address + page * pageSize));
+		nodes.push_back(best);
+
+		if (batch.size() == INTERLEAVE_BATCH_PAGES || page + 1 == pages) {
+			status.assign(batch.size(), 0);
+			if (move_pages(0, batch.size(), batch.data(), nodes.data(), status.data(), MPOL_MF_MOVE) < 0) {
+				error = errno;
+				failed += batch.size();
+			} else {
+				failed += std::count_if(status.begin(), status.end(), [](int node) { return node < 0; });
+			}
+			batch.clear();
+			nodes.clear();
+		}
+	}
+	mPlacementPolicy = "explicit page placement";
+	if (failed > 0) {
+		mLogger->print(std::to_string(failed) + " of " + std::to_string(pages) + " pages of target " + std::to_string(mID) +
+					   " could not be placed" + (error ? ": " + std::string(strerror(error)) : "") + ".", TARGET_LOGGER_ID);
+	}
+}
+
+void Target::RecordPlacement(uint64_t address, uint64_t size)
+{
+	uint64_t pageSize = GetPageSize();
+	uint64_t pages = size / pageSize;
+	mPageNodes.assign(pages, -1);
+	for (uint64_t first = 0; first < pages; first += INTERLEAVE_BATCH_PAGES) {
+		uint64_t count = std::min<uint64_t>(INTERLEAVE_BATCH_PAGES, pages - first);
+		std::vector<void*> batch(count);
+		for (uint64_t page = 0; page < count; page++) {
+			batch[page] = (void*)(address + (first + page) * pageSize);
+		}
+		// Null nodes only queries where each page is
+		move_pages(0, count, batch.data(), nullptr, mPageNodes.data() + first, 0);
+	}
+
+	std::stringstream ss;
+	ss << "Target " << mID << " pages placed by " << mPlacementPolicy << ":";
+	for (auto & [node, count] : GetPlacement()) {
+		ss << " node " << node << " " << count << " (" << std::fixed << std::setprecision(1) << 100.0 * count / pages << "%)";
+	}
+	mLogger->print(ss.str(), TARGET_LOGGER_ID);
+}
+
+void Target::Interleave(const std::map<uint16_t, uint64_t>& weights)
+{
+	uint64_t pageSize = GetPageSize();
+	uint64_t placedSize = (this->size + pageSize - 1) & ~(pageSize - 1);
+	mBacking.interleave = weights;
+	PlacePages(this->address, placedSize);
+	RecordPlacement(this->address, placedSize);
+}
+
+const std::map<uint16_t, uint64_t>& Target::GetInterleave()
+{
+	return mBacking.interleave;
+}
+
+std::map<uint16_t, uint64_t> Target::GetPlacement()
+{
+	std::map<uint16_t, uint64_t> placement;
+	for (auto & node : mPageNodes) {
+		if (node >= 0) placement[node]++;
+	}
+	return placement;
+}
+
+std::map<uint16_t, double> Target::GetAccessShare()
+{
+	if (mPageNodes.empty()) {
+		return {{mNodeID, 1.0}};
+	}
+	std::map<uint16_t, double> share;
+	uint64_t pageSize = GetPageSize();
+	uint64_t entries = mAddrList->GetEntrySize();
+	const uint64_t* list = mAddrList->GetListPtr();
+	for (uint64_t idx = 0; idx < entries; idx++) {
+		uint64_t page = (list[idx] - this->address) / pageSize;
+		if (page < mPageNodes.size() && mPageNodes[page] >= 0) {
+			share[mPageNodes[page]] += 1.0 / entries;
+		}
+	}
+	return share;
+}
+
+uint64_t Target::AnonHugeBytes(uint64_t address)
+{
+	std::ifstream smaps("/proc/self/smaps");
+	std::stringstream ss;
+	ss << std::hex << address << "-";
+	bool inMapping = false;
+	for (std::string line; getline(smaps, line);) {
+		if (line.rfind(ss.str(), 0) == 0) {
+			inMapping = true;
+		} else if (inMapping && line.rfind("AnonHugePages:", 0) == 0) {
+			return std::stoull(line.substr(line.find(':') + 1)) << 10;
+		}
+	}
+	return 0;
+}
+
+void* Target::MapAnonymous(uint64_t size, bool thp)
+{
+	// THP needs a 2 MB aligned range advised before the first touch, 4k pages opt out of THP
+	uint64_t alignment = thp ? HUGE_2MB : getpagesize();
+	mMapSize = (size + alignment - 1) & ~(alignment - 1);
+	uint64_t reserveSize = mMapSize + alignment;
+	void* reserve = mmap(0, reserveSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (reserve == MAP_FAILED) {
+		return MAP_FAILED;
+	}
+
+	uint64_t aligned = ((uint64_t)reserve + alignment - 1) & ~(alignment - 1);
+	if (aligned > (uint64_t)reserve) {
+		munmap(reserve, aligned - (uint64_t)reserve);
+	}
+	if ((uint64_t)reserve + reserveSize > aligned + mMapSize) {
+		munmap((void*)(aligned + mMapSize), (uint64_t)reserve + reserveSize - (aligned + mMapSize));
+	}
+	madvise((void*)aligned, mMapSize, thp ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+	return (void*)aligned;
+}
+
+bool Target::HugePagesAvailable(uint16_t node, const std::string& page, uint64_t size)
+{
+	if (page != "2m" && page != "1g") {
+		return true;
+	}
+	uint64_t pageSize = (page == "1g") ? HUGE_1GB : HUGE_2MB;
+	std::ifstream freePages("/sys/devices/system/node/node" + std::to_string(node) + "/hugepages/hugepages-" +
+							std::to_string(pageSize >> 10) + "kB/free_hugepages");
+	uint64_t available = 0;
+	if (freePages.good()) {
+		freePages >> available;
+	}
+	return available * pageSize >= size;
+}
+
+bool Target::Remap(const std::string& page)
+{
+	if (!mBacking.path.empty()) {
+		mLogger->print("Target " + std::to_string(mID) + " maps " + mBacking.path + ", its page size comes from the file.", TARGET_LOGGER_ID);
+		return false;
+	}
+	if (page == mBacking.page) {
+		return true;
+	}
+	if (!HugePagesAvailable(mNodeID, page, this->size)) {
+		mLogger->print("Node " + std::to_string(mNodeID) + " lacks free " + page + " huge pages for target " + std::to_string(mID) + ".", TARGET_LOGGER_ID);
+		return false;
+	}
+
+	uint64_t previous = this->address;
+	munmap((void*)previous, mMapSize);
+	mBacking.page = page;
+	this->address = AllocateMemory(this->size);
+	mAddrList->RebaseAddressList((int64_t)(this->address - previous));
+
+	std::stringstream ss;
+	ss << "Target " << mID << " remapped with " << page << " pages at address 0x" << std::hex << this->address;
+	mLogger->print(ss.str(), TARGET_LOGGER_ID);
+	return true;
+}
+
+std::string Target::GetPage()
+{
+	return mBacking.page;
+}
+
+uint64_t Target::GetPageSize()
+{
+	// THP may have fallen back to 4 KB pages, a huge page moves whole through any of its 4 KB pages
+	if (!mBacking.path.empty() || mBacking.page == "4k" || mBacking.page == "thp") {
+		return getpagesize();
+	}
+	if (mBacking.page == "2m" || (mBacking.page.empty() && this->size <= HUGE_2MB)) {
+		return HUGE_2MB;
+	}
+	return HUGE_1GB;
+}
+
+uint64_t Target::GetFileAlignment(int fd)
+{
+	struct stat fileStat;
+	struct statfs fsStat;
+
+	if (fstat(fd, &fileStat) == 0 && S_ISCHR(fileStat.st_mode)) {
+		// devdax publishes its mapping alignment in sysfs
+		std::ifstream alignFile("/sys/dev/char/" + std::to_string(major(fileStat.st_rdev)) + ":" +
+								std::to_string(minor(fileStat.st_rdev)) + "/device/align");
+		uint64_t alignment = DEVDAX_DEFAULT_ALIGN;
+		if (alignFile.good()) {
+			alignFile >> alignment;
+		}
+		return alignment;
+	}
+
+	if (fstatfs(fd, &fsStat) == 0 && fsStat.f_type == HUGETLBFS_MAGIC) {
+		return fsStat.f_bsize;
+	}
+
+	return getpagesize();
+}
+
+void* Target::MapAligned(int fd, uint64_t size, uint64_t alignment, int flags)
+{
+	// Reserve room to slide the mapping onto an aligned address, devdax refuses unaligned ones
+	uint64_t reserveSize = size + alignment;
+	void* reserve = mmap(0, reserveSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (reserve == MAP_FAILED) {
+		return MAP_FAILED;
+	}
+
+	uint64_t aligned = ((uint64_t)reserve + alignment - 1) & ~(alignment - 1);
+	void* mapped = mmap((void*)aligned, size, PROT_READ | PROT_WRITE, flags | MAP_FIXED | MAP_POPULATE, fd, 0);
+	if (mapped == MAP_FAILED) {
+		munmap(reserve, reserveSize);
+		return MAP_FAILED;
+	}
+
+	// Release reservation slack around the mapping
+	if (aligned > (uint64_t)reserve) {
+		munmap(reserve, aligned - (uint64_t)reserve);
+	}
+	if ((uint64_t)reserve + reserveSize > aligned + size) {
+		munmap((void*)(aligned + size), (uint64_t)reserve + reserveSize - (aligned + size));
+	}
+	mMapSize = size;
+	return mapped;
+}
+
+uint64_t Target::MapFile(const std::string& path, uint64_t size)
+{
+	struct stat fileStat;
+
+	BindNode();
+
+	int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd < 0 || fstat(fd, &fileStat) != 0) {
+		mLogger->report_failure("Unable to open " + path + ": " + std::string(strerror(errno)) + "\nExiting Test ...\n");
+		exit(0);
+	}
+
+	uint64_t alignment = GetFileAlignment(fd);
+	uint64_t mapSize = (size + alignment - 1) & ~(alignment - 1);
+
+	// Grow regular and hugetlbfs files, existing content is reused so preallocated files skip allocation
+	if (!S_ISCHR(fileStat.st_mode) && (uint64_t)fileStat.st_size < mapSize) {
+		if (ftruncate(fd, mapSize) != 0) {
+			mLogger->report_failure("Unable to grow " + path + " to " + std::to_string(mapSize) + " bytes: " + std::string(strerror(errno)));
+			close(fd);
+			exit(0);
+		}
+	}
+
+	std::string mode = "MAP_SHARED_VALIDATE | MAP_SYNC";
+	void* LogicalAddressCopy = MapAligned(fd, mapSize, alignment, MAP_SHARED_VALIDATE | MAP_SYNC);
+	if (LogicalAddressCopy == MAP_FAILED) {
+		// Not a DAX capable file, fall back to a plain shared mapping
+		mode = "MAP_SHARED";
+		LogicalAddressCopy = MapAligned(fd, mapSize, alignment, MAP_SHARED);
+	}
+	close(fd);
+
+	if (LogicalAddressCopy == MAP_FAILED)
+	{
+		mLogger->report_failure("Unable to map " + std::to_string(mapSize) + " Bytes of " + path + ": " + std::string(strerror(errno)) +
+								"\nExiting Test ...\n");
+		exit(0);
+	}
+
+	std::stringstream ss;
+	ss << "Mapped " << path << " with " << mode << ", size 0x" << std::hex << mapSize << ", alignment 0x" << alignment;
+	mLogger->print(ss.str(), TARGET_LOGGER_ID);
+
+	mlock((const void*)LogicalAddressCopy, (size_t)mapSize);
+
 	return (uint64_t)LogicalAddressCopy;
 }
 
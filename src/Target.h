@@ -7,8 +7,10 @@
 
 #pragma once
 #include <iostream>
+#include <string>
 #include <vector>
 #include <memory>
+#include <map>
 #include "cxl/CxlTypes.h"
 
 #include "AddressList.h"
@@ -16,6 +18,29 @@
 
 #define MAPSIZE 0x100000
 
+/**
+ * @brief Optional backing settings of a target given with --define-target.
+ * Empty path selects anonymous memory. Its page size is 4k, thp, 2m (hugetlb) or 1g (hugetlb),
+ * empty page picks hugetlb pages from the size (2 MB pages up to 2 MB, 1 GB pages above).
+ * A non empty interleave (node -> weight) spreads anonymous pages over several nodes, e.g. 3:1 DRAM:CXL.
+ */
+typedef struct {
+    std::string path;
+    std::string page;
+    std::map<uint16_t, uint64_t> interleave;
+} TargetBacking;
+
+/**
+ * @brief Address list geometry of a target as written in hammer file, addr_incr in cache lines.
+ */
+typedef struct {
+    uint64_t addr_start;
+    uint64_t num_sets;
+    uint64_t set_offset_incr;
+    uint64_t num_addr_incr;
+    uint64_t addr_incr;
+} TargetGeometry;
+
 /**
  * @class Target
  * @brief The Target class provides functions to allocate memory, touch pages, unmap memory, and get address list.
@@ -29,6 +54,19 @@ class Target
     uint16_t mNodeID;
     std::shared_ptr<AddressList> mAddrList;
     std::shared_ptr<Logger> mLogger;
+    TargetBacking mBacking;
+    uint64_t mMapSize = 0;
+    uint64_t mCapacity = 0;
+    std::vector<int> mPageNodes;
+    std::string mPlacementPolicy;
+    void BindNode(void);
+    bool WeightedInterleave(void* address, uint64_t size);
+    void PlacePages(uint64_t address, uint64_t size);
+    void RecordPlacement(uint64_t address, uint64_t size);
+    void* MapAnonymous(uint64_t size, bool thp);
+    uint64_t AnonHugeBytes(uint64_t address);
+    uint64_t GetFileAlignment(int fd);
+    void* MapAligned(int fd, uint64_t size, uint64_t alignment, int flags);
 
     public:
         uint64_t mrequiredSize = 0;
@@ -60,10 +98,11 @@ class Target
          * @param setOffsetAddrIncr The set offset address increment of the target.
          * @param numAddrIncr The number of address increments of the target.
          * @param addrIncr The address increment of the target.
+         * @param backing Optional backing, a path maps a devdax device, hugetlbfs file or regular file instead of anonymous memory.
          */
         Target(uint32_t id, uint16_t node_id,
             uint64_t addrStart, uint16_t numSets, uint64_t setOffsetAddrIncr,
-            uint16_t numAddrIncr, uint64_t addrIncr);
+            uint16_t numAddrIncr, uint64_t addrIncr, const TargetBacking& backing = TargetBacking());
 
         uint64_t address = 0, size = 0;
 
@@ -73,12 +112,26 @@ class Target
          * This function allocates memory with the given size. If the size is <= 2 MB, it uses the huge page size of 2 MB.
          * If the size is between 2 MB and 1 GB, it uses the huge page size of more than 2 MB. 
          * If the size is > 1 GB, it reports an error message.
+         * A page size given with --page overrides the choice, 4k and thp use regular anonymous memory.
          * 
          * @param size Size of the memory to be allocated.
          * @return uint64_t Logical address of the allocated memory.
          */
         uint64_t AllocateMemory(uint64_t size);
 
+        /**
+         * @brief Maps size bytes of a file into memory.
+         *
+         * Supports devdax character devices, hugetlbfs files and regular (or tmpfs) files. The mapping is aligned
+         * to the device alignment or huge page size, shared, and synchronous (MAP_SYNC) when the file supports it.
+         * Regular and hugetlbfs files are created and grown when needed, so preallocated files survive across runs.
+         *
+         * @param path Path of the file to map.
+         * @param size Size of the memory to be mapped.
+         * @return uint64_t Logical address of the mapped memory.
+         */
+        uint64_t MapFile(const std::string& path, uint64_t size);
+
         /**
          * @brief Accesses the address list at a given index.
          * If the index is out-of-bound, function throws an invalid argument exception.
@@ -95,12 +148,112 @@ class Target
          */
         void UnMapMemory(unsigned long* vAddr,off_t mapSize);
 
+        /**
+         * @return uint32_t Target id given in hammer file.
+         */
+        uint32_t GetID();
+
+        /**
+         * @return uint16_t NUMA node the target memory is bound to.
+         */
+        uint16_t GetNodeID();
+
         /**
          * @brief Gets the shared pointer to address list.
          * @return std::shared_ptr<AddressList> Shared pointer to the address list.
          */
         std::shared_ptr<AddressList> GetAddressList();
 
+        /**
+         * @brief Replaces the address list with one of a new geometry inside the memory already allocated.
+         * Exits the test when the geometry needs more memory than the target holds.
+         * @param geometry New geometry, switches as given in hammer file.
+         */
+        void Reshape(const TargetGeometry& geometry);
+
+        /**
+         * @brief Hands the memory already allocated to another hammer target, used by daemon mode.
+         * The target takes the new id and geometry, its size shrinks to what the geometry needs.
+         * Exits the test when the geometry needs more memory than was allocated.
+         * @param id Target id given in hammer file.
+         * @param geometry Geometry of the hammer target, addr_incr in cache lines.
+         */
+        void Lease(uint32_t id, const TargetGeometry& geometry);
+
+        /**
+         * @brief Unmaps the target memory, used by daemon mode when a pooled target is replaced by a larger one.
+         * The target must not be used afterwards.
+         */
+        void Release(void);
+
+        /**
+         * @return Bytes allocated when the target was built, the most any geometry can use.
+         */
+        uint64_t GetCapacity(void);
+
+        /**
+         * @return Backing given with --define-target.
+         */
+        const TargetBacking& GetBacking(void);
+
+        /**
+         * @brief Moves an anonymous target to pages of another size, the address list follows the new mapping.
+         * Target contents are lost.
+         * @param page 4k, thp, 2m or 1g.
+         * @return false if the node lacks free huge pages of that size or the target maps a file, the target is left untouched then.
+         */
+        bool Remap(const std::string& page);
+
+        /**
+         * @brief Checks the free huge page pool of a node before mapping, MAP_NORESERVE mappings would SIGBUS on first touch.
+         * @param node NUMA node the pages come from.
+         * @param page 4k, thp, 2m or 1g, only 2m and 1g need free huge pages.
+         * @param size Bytes the mapping needs.
+         * @return true if the node can back size bytes with that page size.
+         */
+        static bool HugePagesAvailable(uint16_t node, const std::string& page, uint64_t size);
+
+        /**
+         * @return Page size selected with --page, empty when picked from the size.
+         */
+        std::string GetPage(void);
+
+        /**
+         * @return Bytes per page of the target mapping, the unit pages migrate in.
+         */
+        uint64_t GetPageSize(void);
+
+        /**
+         * @return Interleave weights given with --interleave, empty when the target sits on its node.
+         */
+        const std::map<uint16_t, uint64_t>& GetInterleave(void);
+
+        /**
+         * @brief Moves the pages of an interleaved target to new weights, contents are kept.
+         * @param weights Weight per node, nodes weighted 0 get no pages.
+         */
+        void Interleave(const std::map<uint16_t, uint64_t>& weights);
+
+        /**
+         * @return Pages of the target on each node, as found right after the last placement.
+         */
+        std::map<uint16_t, uint64_t> GetPlacement(void);
+
+        /**
+         * @brief Share of the address list entries whose page sits on each node, used to split
+         * generator bandwidth of interleaved targets per node.
+         */
+        std::map<uint16_t, double> GetAccessShare(void);
+
+        /**
+         * @brief Overrides one --define-target switch of a geometry, the value is read like in hammer file.
+         * @param geometry Geometry to update.
+         * @param name Switch name without dashes, e.g. num-sets.
+         * @param value Switch value, hex for set-offset-incr and addr-incr.
+         * @return false if name is not a geometry switch.
+         */
+        static bool SetGeometry(TargetGeometry& geometry, const std::string& name, const std::string& value);
+
         /**
          * @brief Touches the pages starting from the `LogicalAddress2` and going through `MemorySpan` bytes.
          * @param LogicalAddress2 The start address of the memory region to touch.
@@ -6,8 +6,31 @@
 **/
 
 #include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 
 #include "Test.h"
+#include "utils/IsaKernels.h"
+#include "utils/Snapshot.h"
+#include "utils/Pagemap.h"
+#include "cxl/CxlAddressMap.h"
+
+// Track of the phase spans, kept apart from generator hw ids
+#define TIMELINE_PHASE_TID      0xFFFF
+// Convergence looks at the loop rate of the last CONVERGE_WINDOWS windows
+#define CONVERGE_WINDOW_MS      100
+#define CONVERGE_WINDOWS        10
+// Device generators are polled for the live statistics segment at this period
+#define LIVE_POLL_MS            100
+
+/* Two sided 95% Student t quantile for the given degrees of freedom. */
+static double student_t95(std::size_t dof) {
+    static const double quantiles[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                       2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086};
+    return (dof >= 1 && dof <= 20) ? quantiles[dof - 1] : 1.960;
+}
 
 Test::Test() {
     this->logger = Logger::build();
@@ -43,24 +66,35 @@ void Test::load_generators(void){
         loops = std::stoi(thread_definition["setloops"]);
         pattern_param = std::stoi(thread_definition["patternparam"]);
         cache_aligned = std::stoi(thread_definition["cachealigned"]);
-        thread_target = std::stoi(thread_definition["target"]);
+        /* First target is the one the thread works on, further ones are sources (e.g. --target=dst,src) */
+        std::vector<uint64_t> thread_targets;
+        std::stringstream ss_targets(thread_definition["target"]);
+        for (std::string target_id; getline(ss_targets, target_id, ',');) {
+            thread_targets.push_back(std::stoull(target_id));
+        }
+        thread_target = thread_targets.front();
 
         /* Get target address */ 
-        if (targets.find(thread_target) == targets.end()){
-            this->logger->report_failure("Target ID not found.");
-            exit(0);
+        for (auto & target_id : thread_targets) {
+            if (targets.find(target_id) == targets.end()){
+                this->logger->report_failure("Target ID not found.");
+                exit(0);
+            }
         }
 
-        auto algo = algo_manager->build_algo(thread_definition["algorithm"]);
         auto addrList = targets[thread_target]->GetAddressList();
 
         if (thread_definition["type"] == "core") {
-            auto algoInst = std::make_shared<MulWrStreamNew>(algo_params_offset, pattern, thread_offset, thread_size);
+            auto algoInst = this->build_algorithm(thread_definition);
             auto generator = std::make_shared<CpuTrafficGenerator>();
             generator->setAffinity(hw_id);
             generator->setAlgorithm(algoInst);
             generator->setAddressList(std::move(addrList));
+            if (this->perf_counters) {
+                generator->enablePerfCounters(this->perf_raw_events);
+            }
             this->generators.push_back(generator);
+            this->generators_by_hwid[hw_id] = generator;
         } else if (thread_definition["type"] == "device") { 
             auto algoInst = std::make_shared<MulWrStreamNew>(algo_params_offset, pattern, thread_offset, thread_size);
             auto generator = std::make_shared<DeviceTrafficGenerator>(addrList, pattern, pattern_size, pattern_param, 0, hw_id, 0, 0, protocol_id);
@@ -74,6 +108,7 @@ void Test::load_generators(void){
             generator->setAlgoParams(algo_params_offset);
             generator->setProtocol(protocol_id);
             this->generators.push_back(generator);
+            this->generators_by_hwid[hw_id] = generator;
         }
     }
 
@@ -82,43 +117,705 @@ void Test::load_generators(void){
         this->logger->report_failure("No thread-types specified in test file, nothing to run. Do you even Cxl?");
         exit(0);
     }
+
+    /* Timeline tracks, one per generator plus the phase track */
+    if (!this->timeline_file.empty()) {
+        for (auto & [hw_id, generator] : this->generators_by_hwid) {
+            auto buffer = std::make_shared<TimelineBuffer>(this->threads_define[hw_id]["type"] + " " + std::to_string(hw_id),
+                                                           hw_id, this->timeline_events);
+            generator->setTimeline(buffer);
+            this->timeline_buffers.push_back(buffer);
+        }
+        this->timeline_buffers.push_back(std::make_shared<TimelineBuffer>("phases", TIMELINE_PHASE_TID, this->timeline_events));
+    }
+
+    if (!this->live_name.empty()) {
+        this->attach_live();
+    }
+
+    /* Verify phases only reference defined threads */
+    for (auto & [phase_id, phase] : this->phases) {
+        for (auto & hw_id : phase.threads) {
+            if (this->generators_by_hwid.find(hw_id) == this->generators_by_hwid.end()) {
+                this->logger->report_failure("Phase " + std::to_string(phase_id) + " references undefined thread " + std::to_string(hw_id) + ".");
+                exit(0);
+            }
+        }
+    }
+}
+
+std::shared_ptr<IAlgorithm> Test::build_algorithm(std::unordered_map<std::string, std::string>& thread_definition){
+    uint32_t algo_params_offset;
+    uint64_t pattern, thread_offset, thread_size;
+
+    std::stringstream ss_algo_params(thread_definition["algo-params"]);
+    ss_algo_params.flags(std::ios_base::hex);
+    ss_algo_params >> algo_params_offset;
+
+    std::stringstream ss_offset(thread_definition["offset"]);
+    ss_offset.flags(std::ios_base::dec);
+    ss_offset >> thread_offset;
+
+    std::stringstream ss_pattern(thread_definition["pattern"]);
+    ss_pattern.flags(std::ios_base::hex);
+    ss_pattern >> pattern;
+
+    thread_size = std::stoi(thread_definition["size"]);
+
+    std::vector<uint64_t> thread_targets;
+    std::stringstream ss_targets(thread_definition["target"]);
+    for (std::string target_id; getline(ss_targets, target_id, ',');) {
+        thread_targets.push_back(std::stoull(target_id));
+    }
+    auto & target = this->targets[thread_targets.front()];
+
+    AlgoConfig config = {algo_params_offset, pattern, (uint8_t)thread_offset, (uint8_t)thread_size,
+                         target->address, target->size, thread_definition};
+    config.target_node = target->GetNodeID();
+    for (std::size_t idx = 1; idx < thread_targets.size(); idx++) {
+        auto & source = this->targets[thread_targets[idx]];
+        config.sources.push_back({thread_targets[idx], source->GetNodeID(), source->address, source->size});
+    }
+    return this->algo_manager->build_algo(thread_definition["algorithm"], config);
+}
+
+bool Test::reconfigure(std::uint64_t hw_id, const std::unordered_map<std::string, std::string>& changes, std::string& error){
+    auto found = this->generators_by_hwid.find(hw_id);
+    auto generator = (found != this->generators_by_hwid.end()) ? std::dynamic_pointer_cast<CpuTrafficGenerator>(found->second) : nullptr;
+    if (!generator) {
+        error = "no core generator with hw id " + std::to_string(hw_id);
+        return false;
+    }
+
+    auto definition = this->threads_define[hw_id];
+    bool rebuild = false;
+    for (auto & [name, value] : changes) {
+        if (name == "rate") {
+            continue;
+        }
+        if (name != "pattern" && name != "offset" && name != "size") {
+            error = "cannot change " + name;
+            return false;
+        }
+        // Only MulWr keeps no state across iterations, a new PingPong or Chase instance would desync or lose its ring
+        if (definition["algorithm"].rfind("MulWr", 0) != 0) {
+            error = "cannot change " + name + " of " + definition["algorithm"];
+            return false;
+        }
+        definition[name] = value;
+        rebuild = true;
+    }
+
+    if (rebuild) {
+        // MulWr exits the test on bad parameters, refuse them before building
+        uint64_t offset = std::stoull(definition["offset"]);
+        uint64_t size = std::stoull(definition["size"]);
+        if ((size != 1 && size != 2 && size != 4 && size != 8) || offset + size > CACHELINE_SIZE) {
+            error = "offset and size must fit a cache line, size 1, 2, 4 or 8";
+            return false;
+        }
+
+        auto algo = this->build_algorithm(definition);
+        algo->setAddressList(this->targets[std::stoull(definition["target"])]->GetAddressList());
+        generator->replaceAlgorithm(algo);
+        for (auto & name : {"pattern", "offset", "size"}) {
+            this->threads_define[hw_id][name] = definition[name];
+        }
+    }
+    auto rate = changes.find("rate");
+    if (rate != changes.end()) {
+        generator->setRate(std::stoull(rate->second));
+    }
+    return true;
+}
+
+void Test::attach_live(void){
+    std::uint32_t count = this->generators_by_hwid.size();
+    // Sweep points rebuild the generators, the segment is kept unless it got too small
+    if (!this->live || this->live->get_header()->slot_count < count) {
+        this->live.reset();
+        auto live = std::make_shared<LiveStats>();
+        if (!live->create(this->live_name, count)) {
+            this->logger->report_failure("Unable to create live statistics segment " + this->live_name + ".");
+            exit(0);
+        }
+        this->live = live;
+        this->logger->print("Live statistics published in " + this->live_name + ".", 200);
+    }
+    this->live->reset(count);
+
+    std::uint32_t idx = 0;
+    for (auto & [hw_id, generator] : this->generators_by_hwid) {
+        auto & definition = this->threads_define[hw_id];
+        std::uint64_t target_id = std::stoull(definition["target"].substr(0, definition["target"].find(',')));
+        LiveGeneratorSlot* slot = this->live->slot(idx++);
+        live_write_begin(slot);
+        slot->hw_id.store(hw_id, std::memory_order_relaxed);
+        slot->type.store((definition["type"] == "core") ? LiveGeneratorCore : LiveGeneratorDevice, std::memory_order_relaxed);
+        slot->node.store(this->targets[target_id]->GetNodeID(), std::memory_order_relaxed);
+        live_write_end(slot);
+        if (definition["type"] == "core") {
+            generator->setLiveSlot(slot);
+        }
+    }
+}
+
+void Test::publish_devices(void){
+    // Device generators accumulate their 8-bit loop counter, totals only grow
+    std::map<std::uint64_t, std::uint64_t> last_loops;
+    std::vector<std::pair<std::uint32_t, std::uint64_t>> devices;
+    std::uint32_t idx = 0;
+    for (auto & [hw_id, generator] : this->generators_by_hwid) {
+        if (this->threads_define[hw_id]["type"] != "core") {
+            devices.push_back({idx, hw_id});
+            last_loops[hw_id] = generator->getLoops();
+        }
+        idx++;
+    }
+    const auto relaxed = std::memory_order_relaxed;
+    for (bool running = true; running;) {
+        running = this->live_running;
+        for (auto & [slot_idx, hw_id] : devices) {
+            auto & generator = this->generators_by_hwid[hw_id];
+            GeneratorSnapshot snapshot = generator->snapshot();
+            std::uint64_t delta = snapshot.loops - last_loops[hw_id];
+            last_loops[hw_id] = snapshot.loops;
+            LiveGeneratorSlot* slot = this->live->slot(slot_idx);
+            live_write_begin(slot);
+            slot->state.store(snapshot.state, relaxed);
+            slot->active.store(snapshot.active, relaxed);
+            slot->loops.store(slot->loops.load(relaxed) + delta, relaxed);
+            slot->bytes.store(slot->bytes.load(relaxed) + delta * generator->getBytesPerLoop(), relaxed);
+            slot->accesses.store(slot->accesses.load(relaxed) + delta * generator->getAccessesPerLoop(), relaxed);
+            live_write_end(slot);
+        }
+        if (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(LIVE_POLL_MS));
+        }
+    }
 }
 
 void Test::configure(void){
-    for (auto & generator : this->generators) {
-       std::thread executor([&]{generator->task();});
-       generator->configure();
-       this->executors.push_back(std::move(executor));
+    // Core threads are pinned before their generator is configured, device tasks poll their loop counter until stop
+    this->executor = std::make_shared<Executor>();
+    this->executor_results.clear();
+    for (auto & [hw_id, generator] : this->generators_by_hwid) {
+        bool core = this->threads_define[hw_id]["type"] == "core";
+        this->executor->spawn(hw_id, generator, core ? (std::int64_t)hw_id : -1);
     }
+    this->executor->launch();
 }
 
 void Test::clear_memory(void){
+    auto kernels = IsaKernels::build();
     for (auto & [id, target] : this->targets) {
         uint64_t target_address = target->address;
-        uint64_t target_size = target->size;
-        this->logger->clear_memory(target_address, target_size, true);
+        // Targets are page aligned, round up to whole cache lines
+        uint64_t target_size = (target->size + CACHELINE_SIZE - 1) & ~(uint64_t)(CACHELINE_SIZE - 1);
+        kernels->fill((void*)target_address, 0, target_size);
+    }
+    // Every page is present now, translations stay valid until pages move
+    this->map_addresses();
+}
+
+void Test::map_addresses(void){
+    auto address_map = CxlAddressMap::build();
+    if (!this->topology) {
+        this->topology = std::make_shared<CxlTopology>();
+        this->topology->discover();
+    }
+    address_map->set_topology(*this->topology);
+    address_map->clear();
+
+    uint64_t pages = 0, known = 0;
+    for (auto & [id, target] : this->targets) {
+        pages += (target->size + PAGEMAP_PAGE_SIZE - 1) / PAGEMAP_PAGE_SIZE;
+        known += address_map->map_range(target->address, target->size);
+    }
+    if (pages != 0 && known == 0) {
+        this->logger->print("Physical addresses are hidden by pagemap, miscompares will not be decoded to CXL devices (run as root).", 200);
     }
 }
 
 void Test::start(void){
     this->logger->print("Starting threads...", 200);
+    // First phase decides which generators issue traffic from the beginning
+    if (!this->phases.empty()) {
+        this->activate(this->phases.begin()->second.threads);
+    }
     for (auto & generator : this->generators) {
         generator->start();
     }
+    if (this->live) {
+        this->live_running = true;
+        this->live_publisher = std::thread([this] { this->publish_devices(); });
+    }
     // Let everything to start running
     std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    this->migration_corrupted = 0;
+    for (auto & migration : this->migrations) {
+        if (this->targets.find(migration.target) == this->targets.end()) {
+            this->logger->report_failure("Migration references undefined target " + std::to_string(migration.target) + ".");
+            exit(0);
+        }
+        auto engine = std::make_shared<Migration>(migration, this->targets[migration.target], this->generators_by_hwid);
+        engine->start();
+        this->migration_engines.push_back(engine);
+    }
 }
 
 void Test::stop(void){
+    if (!this->migration_engines.empty()) {
+        this->logger->print("Stopping page migration.", 200);
+        for (auto & engine : this->migration_engines) {
+            engine->stop();
+            engine->print();
+            this->migration_corrupted += engine->get_corrupted_lines();
+        }
+        this->migration_engines.clear();
+    }
     this->logger->print("Stopping threads.", 200);
     for (auto & generator : generators) {
         generator->stop();
     }
-    // waiti for threads, paciently
-    std::this_thread::sleep_for(std::chrono::seconds(1));
     this->logger->print("Waiting for threads...", 200);
-    for (auto & executor : this->executors) {
-    executor.join();
+    if (this->executor) {
+        this->executor_results = this->executor->join(std::chrono::milliseconds(this->join_timeout_ms));
+    }
+    if (this->live_publisher.joinable()) {
+        this->live_running = false;
+        this->live_publisher.join();
+    }
+}
+
+void Test::activate(const std::vector<std::uint64_t>& threads){
+    for (auto & [hw_id, generator] : this->generators_by_hwid) {
+        bool active = std::find(threads.begin(), threads.end(), hw_id) != threads.end();
+        generator->setActive(active);
+    }
+}
+
+std::vector<GeneratorStats> Test::sample_generators(void){
+    std::vector<GeneratorStats> samples;
+    for (auto & [hw_id, generator] : this->generators_by_hwid) {
+        GeneratorSnapshot snapshot = generator->snapshot();
+        samples.push_back({hw_id, snapshot.active, snapshot.loops, 0, 0});
+    }
+    return samples;
+}
+
+PhaseStats Test::collect_phase(std::uint64_t phase_id, std::uint64_t elapsed_ns,
+                               const std::vector<GeneratorStats>& begin){
+    PhaseStats stats = {phase_id, elapsed_ns, this->sample_generators()};
+    for (std::size_t idx = 0; idx < stats.generators.size(); idx++) {
+        auto & generator = this->generators_by_hwid[stats.generators[idx].hw_id];
+        uint64_t loops = stats.generators[idx].loops - begin[idx].loops;
+        stats.generators[idx].active = begin[idx].active;
+        stats.generators[idx].loops = loops;
+        stats.generators[idx].bytes = loops * generator->getBytesPerLoop();
+        stats.generators[idx].accesses = loops * generator->getAccessesPerLoop();
+    }
+    return stats;
+}
+
+void Test::print_phase(const PhaseStats& stats){
+    std::stringstream ss;
+    double seconds = stats.elapsed_ns / 1e9;
+    ss << "Phase " << stats.phase_id << " statistics (" << std::fixed << std::setprecision(3) << seconds << " s)";
+    this->logger->print(ss.str(), 200);
+    ss.str(std::string());
+
+    ss << "| " << std::setw(8) << "hwid" << std::setw(8) << "active" << std::setw(16) << "loops"
+       << std::setw(16) << "MB/s" << std::setw(16) << "Mops/s" << std::setw(16) << "ns/access";
+    this->logger->print(ss.str(), 2);
+    uint64_t active = 0, bytes = 0, accesses = 0;
+    for (auto & generator : stats.generators) {
+        ss.str(std::string());
+        double bandwidth = (seconds > 0) ? (generator.bytes / seconds) / 1e6 : 0;
+        double rate = (seconds > 0) ? (generator.accesses / seconds) / 1e6 : 0;
+        double latency = (generator.accesses > 0) ? (double)stats.elapsed_ns / generator.accesses : 0;
+        ss << "| " << std::setw(8) << generator.hw_id << std::setw(8) << (generator.active ? "yes" : "no")
+           << std::setw(16) << generator.loops << std::setw(16) << std::setprecision(2) << bandwidth
+           << std::setw(16) << rate << std::setw(16) << latency;
+        this->logger->print(ss.str(), 2);
+        active += generator.active ? 1 : 0;
+        bytes += generator.bytes;
+        accesses += generator.accesses;
+    }
+    // Aggregate over the active generators, which contend with each other on shared targets
+    ss.str(std::string());
+    ss << "| " << std::setw(8) << "total" << std::setw(8) << active << std::setw(16) << ""
+       << std::setw(16) << ((seconds > 0) ? (bytes / seconds) / 1e6 : 0)
+       << std::setw(16) << ((seconds > 0) ? (accesses / seconds) / 1e6 : 0) << std::setw(16) << "";
+    this->logger->print(ss.str(), 2);
+    this->print_nodes(stats);
+
+    if (stats.convergence.empty()) {
+        return;
+    }
+    ss.str(std::string());
+    ss << (stats.converged ? "Converged" : "Not converged, maximum time reached") << ", steady state over the last "
+       << CONVERGE_WINDOWS << " windows of " << CONVERGE_WINDOW_MS << " ms (95% confidence)";
+    this->logger->print(ss.str(), 200);
+    ss.str(std::string());
+    ss << "| " << std::setw(8) << "hwid" << std::setw(10) << "cv" << std::setw(28) << "MB/s" << std::setw(28) << "ns/access";
+    this->logger->print(ss.str(), 2);
+    for (auto & estimate : stats.convergence) {
+        ss.str(std::string());
+        std::stringstream bandwidth, latency;
+        bandwidth << std::fixed << std::setprecision(2) << estimate.mbps << " +/- " << estimate.ci_mbps;
+        latency << std::fixed << std::setprecision(2) << estimate.ns_per_access << " +/- " << estimate.ci_ns_per_access;
+        ss << "| " << std::setw(8) << estimate.hw_id << std::setw(10) << std::setprecision(4) << estimate.cv
+           << std::setw(28) << bandwidth.str() << std::setw(28) << latency.str();
+        this->logger->print(ss.str(), 2);
+    }
+}
+
+void Test::print_nodes(const PhaseStats& stats){
+    bool interleaved = false;
+    for (auto & [id, target] : this->targets) {
+        interleaved = interleaved || !target->GetInterleave().empty();
+    }
+    if (!interleaved) {
+        return;
+    }
+
+    // Traffic of a generator is split by where the pages of its address list sit
+    std::map<uint16_t, double> node_bytes;
+    double bytes = 0;
+    for (auto & generator : stats.generators) {
+        auto & target = this->targets[std::stoull(this->threads_define[generator.hw_id]["target"])];
+        for (auto & [node, share] : target->GetAccessShare()) {
+            node_bytes[node] += generator.bytes * share;
+        }
+        bytes += generator.bytes;
+    }
+    double seconds = stats.elapsed_ns / 1e9;
+    std::stringstream ss;
+    ss << "| " << std::setw(8) << "node" << std::setw(16) << "MB/s" << std::setw(16) << "share %";
+    this->logger->print(ss.str(), 2);
+    for (auto & [node, node_total] : node_bytes) {
+        ss.str(std::string());
+        ss << "| " << std::setw(8) << node << std::fixed << std::setprecision(2)
+           << std::setw(16) << ((seconds > 0) ? (node_total / seconds) / 1e6 : 0)
+           << std::setw(16) << ((bytes > 0) ? 100 * node_total / bytes : 0);
+        this->logger->print(ss.str(), 2);
+    }
+}
+
+bool Test::converged(const std::map<std::uint64_t, std::vector<double>>& rates, std::vector<ConvergenceStats>& estimates){
+    bool all_converged = true;
+    estimates.clear();
+    // Nothing measured is not converged, the phase keeps its duration
+    if (rates.empty()) {
+        return false;
+    }
+    for (auto & [hw_id, samples] : rates) {
+        if (samples.size() < CONVERGE_WINDOWS) {
+            return false;
+        }
+        double mean = 0, variance = 0;
+        for (auto it = samples.end() - CONVERGE_WINDOWS; it != samples.end(); ++it) mean += *it;
+        mean /= CONVERGE_WINDOWS;
+        for (auto it = samples.end() - CONVERGE_WINDOWS; it != samples.end(); ++it) variance += (*it - mean) * (*it - mean);
+        double stddev = std::sqrt(variance / (CONVERGE_WINDOWS - 1));
+        double cv = (mean > 0) ? stddev / mean : INFINITY;
+        // Interval of the mean loop rate, latency is its reciprocal so it carries the same relative error
+        double ci_rate = student_t95(CONVERGE_WINDOWS - 1) * stddev / std::sqrt((double)CONVERGE_WINDOWS);
+
+        auto & generator = this->generators_by_hwid[hw_id];
+        double bytes = generator->getBytesPerLoop();
+        double accesses = generator->getAccessesPerLoop();
+        double ns_per_access = (mean > 0 && accesses > 0) ? 1e9 / (mean * accesses) : 0;
+        estimates.push_back({hw_id, cv, mean * bytes / 1e6, ci_rate * bytes / 1e6,
+                             ns_per_access, (mean > 0) ? ns_per_access * ci_rate / mean : 0});
+        all_converged = all_converged && (cv < this->converge_cv);
+    }
+    return all_converged;
+}
+
+void Test::run(void){
+    // Converging without phases measures every thread in one phase
+    if (this->phases.empty() && this->converge_cv > 0) {
+        Phase phase = {0, this->converge_max_ms, {}};
+        for (auto & [hw_id, generator] : this->generators_by_hwid) {
+            phase.threads.push_back(hw_id);
+        }
+        this->phases[0] = phase;
+    }
+
+    for (auto & [phase_id, phase] : this->phases) {
+        uint64_t duration_ms = (this->converge_cv > 0) ? this->converge_max_ms : phase.duration_ms;
+        if (this->converge_cv > 0) {
+            this->logger->print("Entering phase " + std::to_string(phase_id) + " until converged, at most " + std::to_string(duration_ms) + " ms.", 200);
+        } else {
+            this->logger->print("Entering phase " + std::to_string(phase_id) + " for " + std::to_string(duration_ms) + " ms.", 200);
+        }
+        this->activate(phase.threads);
+
+        auto begin_samples = this->sample_generators();
+        auto begin = std::chrono::steady_clock::now();
+        auto end = begin + std::chrono::milliseconds(duration_ms);
+        uint64_t timeline_begin = Timeline::now();
+
+        // Loop rate of every active generator in each convergence window
+        std::map<std::uint64_t, std::vector<double>> rates;
+        std::map<std::uint64_t, std::uint64_t> window_loops;
+        for (auto & sample : begin_samples) {
+            if (!sample.active) continue;
+            rates[sample.hw_id] = {};
+            window_loops[sample.hw_id] = sample.loops;
+        }
+        if (this->converge_cv > 0 && rates.empty()) {
+            // Idle phase, there is nothing to converge and no reason to wait for converge_max_ms
+            this->logger->print("No active generator in phase " + std::to_string(phase_id) + ", running it for " + std::to_string(phase.duration_ms) + " ms.", 200);
+            end = begin + std::chrono::milliseconds(phase.duration_ms);
+        }
+        auto window_end = begin + std::chrono::milliseconds(CONVERGE_WINDOW_MS);
+        bool phase_converged = false;
+        std::vector<ConvergenceStats> estimates;
+
+        if (this->converge_cv == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+        }
+        while (!phase_converged && std::chrono::steady_clock::now() < end) {
+            std::this_thread::sleep_until(std::min(window_end, end));
+            if (this->converge_cv > 0 && std::chrono::steady_clock::now() >= window_end) {
+                for (auto & [hw_id, samples] : rates) {
+                    uint64_t loops = this->generators_by_hwid[hw_id]->getLoops();
+                    samples.push_back((loops - window_loops[hw_id]) * 1000.0 / CONVERGE_WINDOW_MS);
+                    window_loops[hw_id] = loops;
+                }
+                window_end += std::chrono::milliseconds(CONVERGE_WINDOW_MS);
+                phase_converged = this->converged(rates, estimates);
+            }
+        }
+        if (!this->timeline_buffers.empty()) {
+            auto & phase_track = this->timeline_buffers.back();
+            phase_track->begin_iteration();
+            phase_track->record(TimelineSpanPhase, timeline_begin, Timeline::now(), phase_id);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin);
+
+        this->phase_stats.push_back(this->collect_phase(phase_id, elapsed.count(), begin_samples));
+        this->phase_stats.back().converged = phase_converged;
+        this->phase_stats.back().convergence = estimates;
+        this->print_phase(this->phase_stats.back());
+    }
+}
+
+bool Test::sweep(void){
+    // Every combination of the sweep values, the last sweep changes fastest
+    std::vector<std::vector<std::string>> points = {{}};
+    for (auto & sweep : this->sweeps) {
+        std::vector<std::vector<std::string>> next;
+        for (auto & point : points) {
+            for (auto & value : sweep.values) {
+                next.push_back(point);
+                next.back().push_back(value);
+            }
+        }
+        points = std::move(next);
+    }
+    for (auto & sweep : this->sweeps) {
+        if (sweep.param != "threads") continue;
+        if (!this->phases.empty()) {
+            this->logger->report_failure("Sweeping threads needs a hammer file without phases.");
+            exit(0);
+        }
+        for (auto & value : sweep.values) {
+            if (std::stoull(value) < 1 || std::stoull(value) > this->threads_define.size()) {
+                this->logger->report_failure("Sweep asks for " + value + " threads, " +
+                                             std::to_string(this->threads_define.size()) + " are defined.");
+                exit(0);
+            }
+        }
+    }
+
+    for (auto & sweep : this->sweeps) {
+        if (sweep.param != "interleave") continue;
+        bool interleaved = false;
+        for (auto & [id, target] : this->targets) {
+            if (target->GetInterleave().empty()) continue;
+            interleaved = true;
+            for (auto & value : sweep.values) {
+                if ((std::size_t)std::count(value.begin(), value.end(), ':') + 1 != target->GetInterleave().size()) {
+                    this->logger->report_failure("Interleave " + value + " does not weight the " + std::to_string(target->GetInterleave().size()) +
+                                                 " nodes of target " + std::to_string(id) + ".");
+                    exit(0);
+                }
+            }
+        }
+        if (!interleaved) {
+            this->logger->report_failure("Sweeping interleave needs a target defined with --interleave.");
+            exit(0);
+        }
+    }
+
+    auto base_threads = this->threads_define;
+    auto base_phases = this->phases;
+    std::vector<SweepPoint> results;
+    bool passed = true;
+    for (std::size_t idx = 0; idx < points.size(); idx++) {
+        std::stringstream ss;
+        ss << "Sweep point " << idx + 1 << " of " << points.size() << ":";
+        this->threads_define = base_threads;
+        this->phases = base_phases;
+        auto geometry = this->target_geometry;
+        uint64_t thread_count = base_threads.size();
+        std::string page, interleave;
+        for (std::size_t param = 0; param < this->sweeps.size(); param++) {
+            auto & name = this->sweeps[param].param;
+            auto & value = points[idx][param];
+            ss << " " << name << "=" << value;
+            if (name == "threads") {
+                thread_count = std::stoull(value);
+            } else if (name == "page") {
+                page = value;
+            } else if (name == "interleave") {
+                interleave = value;
+            } else if (name == "offset" || name == "size") {
+                for (auto & [hw_id, thread_definition] : this->threads_define) {
+                    thread_definition[name] = value;
+                }
+            } else {
+                for (auto & [id, target_geometry] : geometry) {
+                    Target::SetGeometry(target_geometry, name, value);
+                }
+            }
+        }
+        this->logger->print(ss.str(), 200);
+        bool remapped = true;
+        for (auto & [id, target] : this->targets) {
+            // File backed targets keep the page size of their file
+            remapped = remapped && (page.empty() || !target->GetBacking().path.empty() || target->Remap(page));
+            target->Reshape(geometry[id]);
+            if (remapped && !interleave.empty() && !target->GetInterleave().empty()) {
+                // Weights apply to the interleaved nodes in ascending node order
+                std::map<uint16_t, uint64_t> weights;
+                std::stringstream ss_weights(interleave);
+                for (auto & [node, weight] : target->GetInterleave()) {
+                    std::string value;
+                    getline(ss_weights, value, ':');
+                    weights[node] = std::stoull(value);
+                }
+                target->Interleave(weights);
+            }
+        }
+        if (!remapped) {
+            this->logger->print("Skipping point, " + page + " pages are not available.", 200);
+            results.push_back({points[idx], 0, 0, 0, 0, -1, true, true});
+            continue;
+        }
+
+        // Targets keep their memory, only generators and their threads are rebuilt
+        this->generators.clear();
+        this->generators_by_hwid.clear();
+        this->executor.reset();
+        this->timeline_buffers.clear();
+        this->phase_stats.clear();
+        this->load_generators();
+
+        if (this->phases.empty()) {
+            // threads=N keeps the N lowest hw ids busy
+            Phase phase = {0, this->sweep_point_ms, {}};
+            for (auto & [hw_id, generator] : this->generators_by_hwid) {
+                if (phase.threads.size() < thread_count) phase.threads.push_back(hw_id);
+            }
+            this->phases[0] = phase;
+        }
+
+        this->configure();
+        this->clear_memory();
+        this->start();
+        this->run();
+        this->stop();
+        bool point_passed = this->verify();
+        passed = passed && point_passed;
+        results.push_back(this->collect_point(points[idx], point_passed));
+    }
+
+    this->print_sweep(results);
+    return passed;
+}
+
+SweepPoint Test::collect_point(const std::vector<std::string>& values, bool passed){
+    SweepPoint point = {values, 0, 0, 0, 0, -1, passed, false};
+    uint64_t elapsed_ns = 0, bytes = 0, accesses = 0, samples = 0;
+    double latency = 0;
+    for (auto & phase : this->phase_stats) {
+        uint64_t active = 0;
+        elapsed_ns += phase.elapsed_ns;
+        for (auto & generator : phase.generators) {
+            bytes += generator.bytes;
+            accesses += generator.accesses;
+            if (generator.active && generator.accesses > 0) {
+                latency += (double)phase.elapsed_ns / generator.accesses;
+                samples++;
+            }
+            active += generator.active ? 1 : 0;
+        }
+        point.active = std::max(point.active, active);
+    }
+    double seconds = elapsed_ns / 1e9;
+    point.mbps = (seconds > 0) ? (bytes / seconds) / 1e6 : 0;
+    point.mops = (seconds > 0) ? (accesses / seconds) / 1e6 : 0;
+    point.ns_per_access = (samples > 0) ? latency / samples : 0;
+
+    // Counters cover the whole life of the generator threads, so do the loops they are divided by
+    double dtlb_misses = 0, counted_accesses = 0;
+    for (auto & [hw_id, generator] : this->generators_by_hwid) {
+        auto cpu_generator = std::dynamic_pointer_cast<CpuTrafficGenerator>(generator);
+        auto perf = cpu_generator ? cpu_generator->getPerfCounters() : nullptr;
+        if (!perf || !perf->has("dtlb-misses")) continue;
+        dtlb_misses += perf->value("dtlb-misses");
+        counted_accesses += (double)generator->getLoops() * generator->getAccessesPerLoop();
+    }
+    if (counted_accesses > 0) {
+        point.dtlb_per_access = dtlb_misses / counted_accesses;
+    }
+    return point;
+}
+
+void Test::print_sweep(const std::vector<SweepPoint>& points){
+    std::stringstream ss;
+    ss << "Sweep statistics (" << points.size() << " points)";
+    this->logger->print(ss.str(), 200);
+    ss.str(std::string());
+
+    ss << "| ";
+    for (auto & sweep : this->sweeps) {
+        ss << std::setw(16) << sweep.param;
+    }
+    ss << std::setw(8) << "active" << std::setw(16) << "MB/s" << std::setw(16) << "Mops/s"
+       << std::setw(16) << "ns/access";
+    if (this->perf_counters) ss << std::setw(16) << "dTLB/access";
+    ss << std::setw(8) << "verify";
+    this->logger->print(ss.str(), 2);
+    for (auto & point : points) {
+        ss.str(std::string());
+        ss << "| ";
+        for (auto & value : point.values) {
+            ss << std::setw(16) << value;
+        }
+        if (point.skipped) {
+            ss << std::setw(8) << "-" << std::setw(16) << "-" << std::setw(16) << "-" << std::setw(16) << "-";
+            if (this->perf_counters) ss << std::setw(16) << "-";
+            ss << std::setw(8) << "skip";
+            this->logger->print(ss.str(), 2);
+            continue;
+        }
+        ss << std::setw(8) << point.active << std::fixed << std::setprecision(2) << std::setw(16) << point.mbps
+           << std::setw(16) << point.mops << std::setw(16) << point.ns_per_access;
+        if (this->perf_counters) {
+            std::stringstream dtlb;
+            if (point.dtlb_per_access < 0) dtlb << "n/a";
+            else dtlb << std::fixed << std::setprecision(4) << point.dtlb_per_access;
+            ss << std::setw(16) << dtlb.str();
+        }
+        ss << std::setw(8) << (point.passed ? "pass" : "fail");
+        this->logger->print(ss.str(), 2);
     }
 }
 
@@ -134,6 +831,16 @@ bool Test::verify(void){
             errFlag = 1;
         }
     }
+    if (this->migration_corrupted != 0) {
+        errFlag = 1;
+    }
+    // Tasks that threw, failed to set up or never returned
+    for (auto & result : this->executor_results) {
+        if (result.code == 0) continue;
+        errFlag = 1;
+        this->logger->report_failure("Thread " + std::to_string(result.hw_id) + ": " +
+                                     (result.error.empty() ? "task returned " + std::to_string(result.code) : result.error) + ".");
+    }
     if (errFlag != 0) {
         this->logger->print("TEST FAILED.", 200);
         // To dump the AFU register values in case of failure
@@ -161,4 +868,37 @@ void Test::dump(void){
         generator->print();
     }
 
-}
\ No newline at end of file
+}
+
+bool Test::snapshot(const std::string& file){
+    std::vector<SnapshotThread> threads;
+    for (auto & [hw_id, thread_definition] : this->threads_define) {
+        SnapshotThread thread;
+        thread.hw_id = hw_id;
+        thread.target = std::stoull(thread_definition["target"]);
+        if (thread_definition["type"] == "device") {
+            thread.type = SNAPSHOT_THREAD_DEVICE;
+        } else {
+            thread.type = (thread_definition["algorithm"].rfind("MulWr", 0) == 0) ? SNAPSHOT_THREAD_CORE : SNAPSHOT_THREAD_OTHER;
+        }
+        thread.algo_params = std::stoull(thread_definition["algo-params"], nullptr, 16);
+        thread.pattern = std::stoull(thread_definition["pattern"], nullptr, 16);
+        thread.offset = std::stoull(thread_definition["offset"]);
+        thread.size = std::stoull(thread_definition["size"]);
+        thread.pattern_param = std::stoull(thread_definition["patternparam"]);
+        threads.push_back(thread);
+    }
+
+    this->logger->print("Writing snapshot " + file + ".", 200);
+    Snapshot snapshot;
+    return snapshot.write(file, this->targets, threads) == 0;
+}
+
+bool Test::write_timeline(void){
+    if (!Timeline::write(this->timeline_file, this->timeline_buffers)) {
+        this->logger->report_failure("Unable to write timeline " + this->timeline_file + ".");
+        return false;
+    }
+    this->logger->print("Timeline written to " + this->timeline_file + ".", 200);
+    return true;
+}
@@ -13,36 +13,134 @@
 #include "algo/AlgoManager.h"
 #include "algo/MulWrStream.h"
 #include "utils/Logger.h"
+#include "utils/Timeline.h"
+#include "utils/LiveStats.h"
+#include "cxl/CxlTopology.h"
 #include "generator/CpuTrafficGenerator.h"
 #include "generator/DeviceTrafficGenerator.h"
 #include "Target.h"
+#include "Migration.h"
+#include "Executor.h"
+#include "TestTypes.h"
 
 class Test {
    private:
     std::shared_ptr<Logger> logger;
+    std::vector<GeneratorStats> sample_generators(void);
+    PhaseStats collect_phase(std::uint64_t phase_id, std::uint64_t elapsed_ns,
+                             const std::vector<GeneratorStats>& begin);
+    void print_phase(const PhaseStats& stats);
+    void print_nodes(const PhaseStats& stats);
+    std::shared_ptr<IAlgorithm> build_algorithm(std::unordered_map<std::string, std::string>& thread_definition);
+    bool converged(const std::map<std::uint64_t, std::vector<double>>& rates, std::vector<ConvergenceStats>& estimates);
+    SweepPoint collect_point(const std::vector<std::string>& values, bool passed);
+    void print_sweep(const std::vector<SweepPoint>& points);
+    void attach_live(void);
+    void map_addresses(void);
+    void publish_devices(void);
+    /* Publishes device generator counters, core generators publish their own slot. */
+    std::thread live_publisher;
+    std::atomic<bool> live_running = false;
 
    public:
     bool display_dump = false;
+    /* Collect perf_event counters on core generator threads. */
+    bool perf_counters = false;
+    std::vector<std::uint64_t> perf_raw_events;
+    /* Per-generator timeline written as Chrome trace JSON, disabled when empty. */
+    std::string timeline_file;
+    std::uint64_t timeline_events = TIMELINE_DEFAULT_EVENTS;
+    std::vector<std::shared_ptr<TimelineBuffer>> timeline_buffers;
+    /* Run each phase until the loop rate coefficient of variation drops below converge_cv, 0 disables. */
+    double converge_cv = 0;
+    std::uint64_t converge_max_ms = CONVERGE_DEFAULT_MAX_MS;
+    /* Shared memory segment read by cxl_top, disabled when live_name is empty. */
+    std::string live_name;
+    std::shared_ptr<LiveStats> live;
+    /* CXL regions miscompare addresses are decoded against, read from /sys when not set. */
+    std::shared_ptr<CxlTopology> topology;
+    /* Sweep directives, every combination of their values runs as one point of sweep(). */
+    std::vector<Sweep> sweeps;
+    std::uint64_t sweep_point_ms = SWEEP_DEFAULT_POINT_MS;
+    /* Target geometry as written in hammer file, sweep points override it. */
+    std::unordered_map<std::uint64_t, TargetGeometry> target_geometry;
+    /* Page migrations defined in hammer file, engines run between start() and stop(). */
+    std::vector<MigrationDefinition> migrations;
+    std::vector<std::shared_ptr<Migration>> migration_engines;
+    /* Cache lines corrupted by verified page moves since start(), fails verify(). */
+    std::uint64_t migration_corrupted = 0;
     /* Targets handle memory management request. */
     std::unordered_map<std::uint64_t, std::shared_ptr<Target>> targets;
     /* Define threads data struct according to total CPUs in system */
     std::map<std::uint64_t, std::unordered_map<std::string, std::string>> threads_define;
     /* Generators object are the ones that run the thread. */
     std::vector<std::shared_ptr<ITrafficGenerator>> generators;
-    /* Threads where generators run on top. */
-    std::vector<std::thread> executors;
+    /* Generators indexed by the hw id used in hammer file. */
+    std::map<std::uint64_t, std::shared_ptr<ITrafficGenerator>> generators_by_hwid;
+    /* Phase blocks defined in hammer file, run in id order by run(). */
+    std::map<std::uint64_t, Phase> phases;
+    /* Statistics collected at the end of each phase. */
+    std::vector<PhaseStats> phase_stats;
+    /* Threads where generators run on top, and how their tasks ended. */
+    std::shared_ptr<Executor> executor;
+    std::vector<ExecutorResult> executor_results;
+    std::uint64_t join_timeout_ms = EXECUTOR_JOIN_TIMEOUT_MS;
     /* manager that creates functions to be run */
     std::shared_ptr<AlgoManager> algo_manager;
     //auto resource_manager = std::make_shared<ResourceManager>();
 
     void load_generators(void);
+    /**
+     * @brief Changes a running core generator, applied by the generator between iterations.
+     * @param hw_id Hw id of the generator.
+     * @param changes pattern (hex), offset and size rebuild the algorithm (MulWr only), rate (MB/s, 0 unthrottled) paces it.
+     * @param error Reason when the change is refused.
+     * @return false if the change was refused, the generator is left untouched then.
+     */
+    bool reconfigure(std::uint64_t hw_id, const std::unordered_map<std::string, std::string>& changes, std::string& error);
+    /**
+     * @brief Runs phase blocks in order, only the threads listed by each phase issue traffic.
+     * Generator threads and targets are kept alive between phases.
+     * With converge_cv set, phases last until every active generator converged or converge_max_ms
+     * passed, and a single phase with every thread runs when the hammer file defines none.
+     */
     void run(void);
+    /**
+     * @brief Activates listed generators and idles the rest.
+     * @param threads hw ids of generators that must issue traffic.
+     */
+    void activate(const std::vector<std::uint64_t>& threads);
+    /**
+     * @brief Runs every point of the sweeps in one process and prints one row per point.
+     * Targets stay allocated, each point reshapes their address lists and rebuilds the generators,
+     * then runs the phases (a single phase of sweep_point_ms when none are defined) and verifies.
+     * The timeline, --dump and --snapshot only reflect the last point.
+     * @return true if every point passed verification.
+     */
+    bool sweep(void);
+    /**
+     * @brief Spawns a pinned thread per generator, configures the generators and releases the threads.
+     */
     void configure(void);
+    /**
+     * @brief Clears every target, then captures the physical pages of the targets for miscompare reports.
+     */
     void clear_memory(void);
     void start(void);
     void stop(void);
     bool verify(void);
     void dump(void);
+    /**
+     * @brief Writes a binary snapshot of every target plus the thread definitions to file.
+     * @param file Snapshot file, compared offline with --diff.
+     * @return true if the snapshot was written.
+     */
+    bool snapshot(const std::string& file);
+    /**
+     * @brief Writes the recorded generator and phase spans to timeline_file.
+     * @return true if the timeline was written.
+     */
+    bool write_timeline(void);
     Test();
     ~Test(){}
 };
\ No newline at end of file
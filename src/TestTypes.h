@@ -0,0 +1,109 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+#include "cxl/CxlTypes.h"
+
+// Longest a phase runs while waiting for convergence (--converge without max)
+#define CONVERGE_DEFAULT_MAX_MS     60000
+// Migration defaults: every page, unthrottled, 1 s bursts separated by 1 s without moves
+#define MIGRATION_DEFAULT_FRACTION  1.0
+#define MIGRATION_DEFAULT_ON_MS     1000
+#define MIGRATION_DEFAULT_OFF_MS    1000
+// Length of a sweep point when the hammer file defines no phases and --converge is off
+#define SWEEP_DEFAULT_POINT_MS      2000
+
+/**
+ * @brief Phase block defined in hammer file with --define-phase.
+ * Phases run in id order, each one for duration_ms with only the listed hw ids active.
+ */
+typedef struct {
+    std::uint64_t id;
+    std::uint64_t duration_ms;
+    std::vector<std::uint64_t> threads;
+} Phase;
+
+/**
+ * @brief Counters collected for a single generator during one phase.
+ */
+typedef struct {
+    std::uint64_t hw_id;
+    bool active;
+    std::uint64_t loops;
+    std::uint64_t bytes;
+    std::uint64_t accesses;
+} GeneratorStats;
+
+/**
+ * @brief Steady state estimate of one generator over the last convergence windows.
+ * ci_* are half widths of the 95% confidence interval of the mean.
+ */
+typedef struct {
+    std::uint64_t hw_id;
+    double cv;
+    double mbps;
+    double ci_mbps;
+    double ns_per_access;
+    double ci_ns_per_access;
+} ConvergenceStats;
+
+/**
+ * @brief Statistics of one phase, collected by Test::run().
+ * convergence is only filled when the phase ran until convergence (--converge).
+ */
+typedef struct {
+    std::uint64_t phase_id;
+    std::uint64_t elapsed_ns;
+    std::vector<GeneratorStats> generators;
+    bool converged = false;
+    std::vector<ConvergenceStats> convergence = {};
+} PhaseStats;
+
+/**
+ * @brief Sweep directive defined in hammer file with --define-sweep.
+ * Every combination of the values of all sweeps runs as one point.
+ */
+typedef struct {
+    std::string param;
+    std::vector<std::string> values;
+} Sweep;
+
+/**
+ * @brief Result of one sweep point, totals over every phase the point ran.
+ * dtlb_per_access is negative when no core generator counted dTLB misses. Skipped points
+ * (pages of the requested size not available) did not run.
+ */
+typedef struct {
+    std::vector<std::string> values;
+    std::uint64_t active;
+    double mbps;
+    double mops;
+    double ns_per_access;
+    double dtlb_per_access;
+    bool passed;
+    bool skipped;
+} SweepPoint;
+
+/**
+ * @brief Page migration defined in hammer file with --define-migration.
+ * While generators run, bursts of on_ms move fraction of the target pages, chunk by chunk, to
+ * whichever of the two nodes they are not on, at most rate pages per second (0 unthrottled).
+ * Bursts are separated by off_ms so generator throughput can be compared with and without moves.
+ */
+typedef struct {
+    std::uint64_t target;
+    int nodes[2];
+    double fraction;
+    std::uint64_t rate;
+    std::uint64_t on_ms;
+    std::uint64_t off_ms;
+    bool verify;
+} MigrationDefinition;
@@ -9,15 +9,37 @@
 
 #include "AlgoManager.h"
 #include "MulWrStream.h"
+#include "TraceReplay.h"
+#include "AtomicRmw.h"
+#include "PingPong.h"
+#include "Stream.h"
+#include "MixStream.h"
+#include "PointerChase.h"
 
 AlgoManager::AlgoManager(){
-	/* Algo directory */
-	algo_types["MulWr"]   = &define_algo<MulWr64>;
-	algo_types["MulWr64"] = &define_algo<MulWr64>;
-	algo_types["MulWr32"] = &define_algo<MulWr32>;
-	// algo_types["MulWrStream"] = &define_algo<MulWrStreamNew>;
+	mLogger = Logger::build();
+	/* Algo directory, operation size comes from --size so all MulWr flavors run MulWrStreamNew */
+	algo_types["MulWr"]   = &define_algo<MulWrStreamNew>;
+	algo_types["MulWr64"] = &define_algo<MulWrStreamNew>;
+	algo_types["MulWr32"] = &define_algo<MulWrStreamNew>;
+	algo_types["Trace"]   = &define_algo<TraceReplay>;
+	algo_types["AtomicXadd"]    = &define_algo<AtomicXadd>;
+	algo_types["AtomicCmpxchg"] = &define_algo<AtomicCmpxchg>;
+	algo_types["AtomicXchg"]    = &define_algo<AtomicXchg>;
+	algo_types["PingPong"]      = &define_algo<PingPong>;
+	algo_types["StreamCopy"]    = &define_algo<StreamCopy>;
+	algo_types["StreamScale"]   = &define_algo<StreamScale>;
+	algo_types["StreamAdd"]     = &define_algo<StreamAdd>;
+	algo_types["StreamTriad"]   = &define_algo<StreamTriad>;
+	algo_types["Mix"]           = &define_algo<MixStream>;
+	algo_types["Chase"]         = &define_algo<PointerChase>;
 }
 
-std::shared_ptr<IAlgorithm> AlgoManager::build_algo(std::string& algo){
-    return algo_types[algo]();
+std::shared_ptr<IAlgorithm> AlgoManager::build_algo(const std::string& algo, const AlgoConfig& config){
+    auto algo_type = algo_types.find(algo);
+    if (algo_type == algo_types.end()) {
+        mLogger->report_failure("Unsupported algorithm " + algo + ".");
+        exit(0);
+    }
+    return algo_type->second(config);
 }
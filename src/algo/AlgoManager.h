@@ -17,17 +17,19 @@ typedef std::shared_ptr<IAlgorithm> algo_pointer;
  * @brief A function template to create a shared pointer to a class that implements the IAlgorithm interface.
  * 
  * @tparam AlgoClass The class to create the shared pointer from.
+ * @param config Thread parameters the algorithm is built with.
  * @return A shared pointer to an instance of the AlgoClass.
  */
-template <typename AlgoClass> algo_pointer define_algo() {
-    return std::make_shared<AlgoClass>();
+template <typename AlgoClass> algo_pointer define_algo(const AlgoConfig& config) {
+    return std::make_shared<AlgoClass>(config);
 }
 
 class AlgoManager
 {
     private:
-        using add_algo = algo_pointer (*)();
+        using add_algo = algo_pointer (*)(const AlgoConfig&);
         std::unordered_map<std::string, add_algo> algo_types;
+        std::shared_ptr<Logger> mLogger;
     protected:
     public:
         /**
@@ -39,9 +41,11 @@ class AlgoManager
 
         /**
          * @brief Builds an algorithm based on the given name.
+         * Exits the test if the algorithm is unknown.
          * 
          * @param algo Name of the algorithm to build.
+         * @param config Thread parameters the algorithm is built with.
          * @return A shared pointer to the built algorithm.
          */
-        std::shared_ptr<IAlgorithm> build_algo(std::string& algo);
+        std::shared_ptr<IAlgorithm> build_algo(const std::string& algo, const AlgoConfig& config);
 };
@@ -0,0 +1,71 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <algorithm>
+
+#include "AtomicRmw.h"
+#include "Primitives.h"
+
+AtomicRmw::AtomicRmw(const AlgoConfig& config, uint8_t op)
+{
+	mOp = op;
+	mOffset = config.offset;
+	mSize = config.size;
+	mPattern = config.pattern;
+
+	if (mSize != 4 && mSize != 8) {
+		mLogger->report_failure("Atomic algorithms support --size=4 or --size=8 only.");
+		exit(0);
+	}
+	// A locked operand crossing a line turns into a bus-wide split lock
+	if (mOffset + mSize > CACHELINE_SIZE) {
+		mLogger->report_failure("Atomic operand at --offset=" + std::to_string(mOffset) + " crosses a cache line.");
+		exit(0);
+	}
+
+	auto lines = config.options.find("lines");
+	if (lines != config.options.end()) {
+		mLines = std::stoull(lines->second);
+	}
+}
+
+uint64_t AtomicRmw::GetLines()
+{
+	uint64_t entries = mpAddrList->GetEntrySize();
+	return (mLines == 0) ? entries : std::min(mLines, entries);
+}
+
+ret_t AtomicRmw::run()
+{
+	const uint64_t *list = mpAddrList->GetListPtr();
+	const uint64_t lines = this->GetLines();
+
+	// Select the operation once, the loops below only issue locked instructions
+	if (mOp == ATOMIC_OP_XADD) {
+		for (uint32_t round = 0; round < ATOMIC_ROUNDS_PER_RUN; round++) {
+			for (uint64_t idx = 0; idx < lines; idx++) {
+				primitive_xadd(list[idx] + mOffset, 1, mSize);
+			}
+		}
+	} else if (mOp == ATOMIC_OP_CMPXCHG) {
+		for (uint32_t round = 0; round < ATOMIC_ROUNDS_PER_RUN; round++) {
+			for (uint64_t idx = 0; idx < lines; idx++) {
+				uint64_t addr = list[idx] + mOffset;
+				uint64_t expected = primitive_read(addr, mSize);
+				while (!primitive_cmpxchg(addr, expected, expected + 1, mSize)) {
+				}
+			}
+		}
+	} else {
+		for (uint32_t round = 0; round < ATOMIC_ROUNDS_PER_RUN; round++) {
+			for (uint64_t idx = 0; idx < lines; idx++) {
+				primitive_xchg(list[idx] + mOffset, mPattern, mSize);
+			}
+		}
+	}
+	return 0;
+}
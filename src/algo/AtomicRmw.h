@@ -0,0 +1,100 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+
+#include "IAlgorithm.h"
+
+// Passes over the shared lines issued by a single run() call
+#define ATOMIC_ROUNDS_PER_RUN    64
+
+#define ATOMIC_OP_XADD       0
+#define ATOMIC_OP_CMPXCHG    1
+#define ATOMIC_OP_XCHG       2
+
+/**
+ * @class AtomicRmw
+ * @brief Locked read-modify-write loops on the lines of the thread address list.
+ * Threads sharing a target contend on the same lines. The operand sits at --offset in each line
+ * and is --size bytes wide (4 or 8). --lines=dec restricts the loop to the first lines of the list.
+ */
+class AtomicRmw : public IAlgorithm
+{
+	private:
+		uint8_t mOp;
+		uint8_t mOffset;
+		uint8_t mSize;
+		uint64_t mLines = 0;
+
+		/**
+		 * @return Number of lines the loop runs on, the address list capped by --lines.
+		 */
+		uint64_t GetLines(void);
+
+	protected:
+		/**
+		 * @brief Validates operand placement. Exits the test on split or unsupported operands.
+		 *
+		 * @param config Thread parameters, uses offset, size and the --lines switch.
+		 * @param op One of ATOMIC_OP_XADD, ATOMIC_OP_CMPXCHG or ATOMIC_OP_XCHG.
+		 */
+		AtomicRmw(const AlgoConfig& config, uint8_t op);
+
+	public:
+		/**
+		 * @brief Runs ATOMIC_ROUNDS_PER_RUN passes of the operation over the shared lines.
+		 * cmpxchg increments the operand, retrying until the exchange succeeds.
+		 */
+		ret_t run(void);
+
+		/**
+		 * @return uint64_t 0x0
+		 */
+		ret_t verify(void) { return 0x0; }
+
+		/**
+		 * @return Operand size, mSize
+		 */
+		uint64_t get_operation_size(void) { return mSize; }
+
+		/**
+		 * @return Bytes read and written, each operation reads and writes its operand.
+		 */
+		uint64_t get_bytes_per_run(void) { return this->get_accesses_per_run() * mSize * 2; }
+
+		/**
+		 * @return Completed read-modify-write operations per run.
+		 */
+		uint64_t get_accesses_per_run(void) { return this->GetLines() * ATOMIC_ROUNDS_PER_RUN; }
+};
+
+/**
+ * @class AtomicXadd
+ */
+class AtomicXadd : public AtomicRmw
+{
+	public:
+		AtomicXadd(const AlgoConfig& config) : AtomicRmw(config, ATOMIC_OP_XADD) {}
+};
+
+/**
+ * @class AtomicCmpxchg
+ */
+class AtomicCmpxchg : public AtomicRmw
+{
+	public:
+		AtomicCmpxchg(const AlgoConfig& config) : AtomicRmw(config, ATOMIC_OP_CMPXCHG) {}
+};
+
+/**
+ * @class AtomicXchg
+ */
+class AtomicXchg : public AtomicRmw
+{
+	public:
+		AtomicXchg(const AlgoConfig& config) : AtomicRmw(config, ATOMIC_OP_XCHG) {}
+};
@@ -12,6 +12,21 @@ IAlgorithm::IAlgorithm() {
     mLogger = Logger::build();
 }
 
+void IAlgorithm::setTimeline(std::shared_ptr<TimelineBuffer> pTimeline)
+{
+	mpTimeline = std::move(pTimeline);
+}
+
+void IAlgorithm::SpanEnd(TimelineSpan span, uint64_t& begin)
+{
+	if (!mpTimeline || !mpTimeline->is_sampled()) {
+		return;
+	}
+	uint64_t end = Timeline::now();
+	mpTimeline->record(span, begin, end);
+	begin = end;
+}
+
 void IAlgorithm::setAddressList(std::shared_ptr<AddressList> pAddrList)
 {
 	mpAddrList = std::move(pAddrList);
@@ -6,11 +6,45 @@
 **/
 
 #pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
 
 #include "cxl/CxlTypes.h"
 #include "utils/Logger.h"
+#include "utils/Timeline.h"
 #include "AddressList.h"
 
+// run() made no progress this call, the generator retries without counting a loop
+#define ALGO_RUN_RETRY    1
+
+/**
+ * @brief Additional target a thread references after the first one in --target=dst,src,...
+ */
+typedef struct {
+	uint64_t id;
+	uint64_t node;
+	uint64_t address;
+	uint64_t size;
+} AlgoTarget;
+
+/**
+ * @brief Parameters of a --define-thread line handed to the algorithm factory.
+ * options holds every switch of the thread line, algorithm specific switches included.
+ * target_* describe the first target of the thread, sources the remaining ones in order.
+ */
+typedef struct {
+	uint32_t params;
+	uint64_t pattern;
+	uint8_t offset;
+	uint8_t size;
+	uint64_t target_address;
+	uint64_t target_size;
+	std::unordered_map<std::string, std::string> options;
+	uint64_t target_node = 0;
+	std::vector<AlgoTarget> sources = {};
+} AlgoConfig;
+
 /**
  * @class IAlgorithm
  * @brief A base interface class for algorithms.
@@ -31,14 +65,54 @@ class IAlgorithm
 		 */
 		std::shared_ptr<AddressList> mpAddrList;
 		std::shared_ptr<Logger> mLogger;
+
+		/**
+		 * @brief Timeline of the generator running the algorithm, null when not recording.
+		 */
+		std::shared_ptr<TimelineBuffer> mpTimeline;
+
+		/**
+		 * @return Current timeline time if the running iteration is sampled, 0 otherwise.
+		 */
+		uint64_t SpanBegin(void) { return (mpTimeline && mpTimeline->is_sampled()) ? Timeline::now() : 0; }
+
+		/**
+		 * @brief Records a stage span from begin to now if the iteration is sampled, begin moves to now.
+		 */
+		void SpanEnd(TimelineSpan span, uint64_t& begin);
 	public:
 		/**
 		 * @brief Sets mpAddrList to point to the passed pointer to an AddressList.
 		 * 
 		 * @param pAddrList A shared pointer to the address list.
 		 */
-		void setAddressList(std::shared_ptr<AddressList> pAddrList);
+		virtual void setAddressList(std::shared_ptr<AddressList> pAddrList);
+
+		/**
+		 * @brief Sets the timeline stage spans are recorded into.
+		 */
+		void setTimeline(std::shared_ptr<TimelineBuffer> pTimeline);
 		virtual uint64_t get_operation_size(void)=0;
+
+		/**
+		 * @return Bytes read and written by a single run() call.
+		 */
+		virtual uint64_t get_bytes_per_run(void) { return 0; }
+
+		/**
+		 * @return Memory accesses (reads, writes and flushes) issued by a single run() call.
+		 */
+		virtual uint64_t get_accesses_per_run(void) { return 0; }
+
+		/**
+		 * @return Algorithm specific results printed with the generator statistics, empty if none.
+		 */
+		virtual std::string get_report(void) { return ""; }
+
+		/**
+		 * @return 0 after a completed iteration, ALGO_RUN_RETRY when the iteration could not complete yet
+		 * (e.g. a peer did not answer) and is neither counted nor an error, negative on error.
+		 */
 		virtual ret_t run()=0;
 		virtual ret_t verify()=0;
 };
@@ -0,0 +1,117 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <regex>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+
+#include "MixStream.h"
+#include "Primitives.h"
+
+MixStream::MixStream(const AlgoConfig& config)
+{
+	// Same pattern widening as MulWrStreamNew::WriteStage()
+	mPattern = (((config.pattern << 32UL) & 0xFFFFFFFFFFFFFFFF) | (config.pattern & 0xFFFFFFFF));
+	mSize = config.size;
+	mOffset = config.offset;
+
+	if (mSize != 1 && mSize != 2 && mSize != 4 && mSize != 8) {
+		mLogger->report_failure("Mix algorithm supports --size=1, 2, 4 or 8.");
+		exit(0);
+	}
+
+	auto mix = config.options.find("mix");
+	if (mix != config.options.end()) {
+		std::smatch ratio;
+		if (!std::regex_match(mix->second, ratio, std::regex("(\\d+):(\\d+)(?::(\\d+))?"))) {
+			mLogger->report_failure("Malformed --mix=" + mix->second + ", expected reads:writes[:flushes].");
+			exit(0);
+		}
+		mWeights[MIX_OP_READ] = std::stoull(ratio[1]);
+		mWeights[MIX_OP_WRITE] = std::stoull(ratio[2]);
+		mWeights[MIX_OP_FLUSH] = ratio[3].matched ? std::stoull(ratio[3]) : 0;
+	}
+	if (mWeights[MIX_OP_READ] + mWeights[MIX_OP_WRITE] + mWeights[MIX_OP_FLUSH] == 0) {
+		mLogger->report_failure("--mix needs at least one non-zero weight.");
+		exit(0);
+	}
+}
+
+void MixStream::BuildOps()
+{
+	uint64_t entries = mpAddrList->GetEntrySize();
+	uint64_t total = mWeights[0] + mWeights[1] + mWeights[2];
+	int64_t current[3] = {0, 0, 0};
+
+	mOps.resize(entries);
+	mCounts[0] = mCounts[1] = mCounts[2] = 0;
+	for (uint64_t idx = 0; idx < entries; idx++) {
+		// Smooth weighted round robin, 2:1 gives R W R R W R ...
+		uint8_t best = 0;
+		for (uint8_t op = 0; op < 3; op++) {
+			current[op] += mWeights[op];
+			if (current[op] > current[best]) best = op;
+		}
+		current[best] -= total;
+		mOps[idx] = best;
+		mCounts[best]++;
+	}
+}
+
+void MixStream::setAddressList(std::shared_ptr<AddressList> pAddrList)
+{
+	IAlgorithm::setAddressList(std::move(pAddrList));
+	this->BuildOps();
+}
+
+uint64_t MixStream::get_bytes_per_run()
+{
+	return (mCounts[MIX_OP_READ] + mCounts[MIX_OP_WRITE]) * mSize;
+}
+
+uint64_t MixStream::get_accesses_per_run()
+{
+	return mOps.size();
+}
+
+ret_t MixStream::run()
+{
+	auto begin = std::chrono::steady_clock::now();
+	const uint64_t *list = mpAddrList->GetListPtr();
+	const uint8_t *ops = mOps.data();
+	const uint64_t entries = mOps.size();
+
+	for (uint64_t idx = 0; idx < entries; idx++) {
+		uint64_t addr = list[idx] + mOffset;
+		if (ops[idx] == MIX_OP_READ) {
+			primitive_read(addr, mSize);
+		} else if (ops[idx] == MIX_OP_WRITE) {
+			primitive_write(addr, mPattern, mSize);
+		} else {
+			primitive_flush(addr);
+		}
+	}
+
+	mRuns++;
+	mElapsedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+	return 0;
+}
+
+std::string MixStream::get_report()
+{
+	if (mElapsedNs == 0) {
+		return "";
+	}
+	std::stringstream ss;
+	double runs_per_ns = (double)mRuns / mElapsedNs;
+	ss << std::fixed << std::setprecision(3) << "mix " << mWeights[MIX_OP_READ] << ":" << mWeights[MIX_OP_WRITE]
+	   << ":" << mWeights[MIX_OP_FLUSH] << ", read " << mCounts[MIX_OP_READ] * mSize * runs_per_ns
+	   << " GB/s, write " << mCounts[MIX_OP_WRITE] * mSize * runs_per_ns << " GB/s, flush "
+	   << mCounts[MIX_OP_FLUSH] * runs_per_ns * 1e3 << " M/s";
+	return ss.str();
+}
@@ -0,0 +1,83 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <string>
+#include <vector>
+
+#include "IAlgorithm.h"
+
+#define MIX_OP_READ     0
+#define MIX_OP_WRITE    1
+#define MIX_OP_FLUSH    2
+
+/**
+ * @class MixStream
+ * @brief Single pass over the address list interleaving reads, writes and flushes at a fixed ratio.
+ * --mix=reads:writes[:flushes], e.g. --mix=2:1 or --mix=3:1:1. Operations are spread evenly
+ * (smooth weighted round robin) and the choice for every address is computed once.
+ */
+class MixStream : public IAlgorithm
+{
+	private:
+		uint64_t mWeights[3] = {1, 1, 0};
+		uint8_t mSize;
+		uint8_t mOffset;
+		std::vector<uint8_t> mOps;
+		uint64_t mCounts[3] = {0, 0, 0};
+
+		uint64_t mRuns = 0;
+		uint64_t mElapsedNs = 0;
+
+		/**
+		 * @brief Assigns an operation to every address list entry.
+		 */
+		void BuildOps(void);
+
+	public:
+		/**
+		 * @brief Parses --mix. Exits the test on malformed ratios.
+		 *
+		 * @param config Thread parameters, uses pattern, offset, size and --mix.
+		 */
+		MixStream(const AlgoConfig& config);
+
+		/**
+		 * @brief Sets the address list and assigns an operation to each of its entries.
+		 */
+		void setAddressList(std::shared_ptr<AddressList> pAddrList);
+
+		/**
+		 * @brief Issues the precomputed operation on every address.
+		 */
+		ret_t run(void);
+
+		/**
+		 * @return uint64_t 0x0
+		 */
+		ret_t verify(void) { return 0x0; }
+
+		/**
+		 * @return Access size, mSize
+		 */
+		uint64_t get_operation_size(void) { return mSize; }
+
+		/**
+		 * @return Bytes read and written per pass.
+		 */
+		uint64_t get_bytes_per_run(void);
+
+		/**
+		 * @return Address list entries, one operation each.
+		 */
+		uint64_t get_accesses_per_run(void);
+
+		/**
+		 * @return Read and write bandwidth and flush rate while the pass ran.
+		 */
+		std::string get_report(void);
+};
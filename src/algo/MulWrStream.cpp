@@ -6,6 +6,7 @@
 **/
 
 #include "MulWrStream.h"
+#include "cxl/CxlAddressMap.h"
 #include <iostream>
 #include <sstream>
 #include <thread>
@@ -35,120 +36,148 @@ ret_t MulWr32::verify()
 
 inline void MulWrStreamNew::FlushStage()
 {
-	uint64_t addr;
-	
-	for (uint32_t idx = 0; idx < mpAddrList->GetEntrySize(); idx++) {
-		addr = (*mpAddrList)[idx] + mOffset;
+	const uint64_t *list = mpAddrList->GetListPtr();
+	const uint64_t entries = mpAddrList->GetEntrySize();
+
+	for (uint64_t idx = 0; idx < entries; idx++) {
+		uint64_t addr = list[idx] + mOffset;
 		asm volatile ("clflush (%0)" :: "r"(addr));
 	}
 }
 
 inline void MulWrStreamNew::WriteStage()
 {
-	uint64_t addr;
+	const uint64_t *list = mpAddrList->GetListPtr();
+	const uint64_t entries = mpAddrList->GetEntrySize();
 	uint8_t writeType = (mParams & 0xF0) >> 4;
 
 	if (writeType == 0) return;
 
-	for (uint32_t idx = 0; idx < mpAddrList->GetEntrySize(); idx++) {
-		std::stringstream ss;
-		addr = (*mpAddrList)[idx] + mOffset;
-		if (writeType == 1 && mSize == 4) {
-			uint32_t pattern = mPattern & 0xFFFFFFFF;
+	// Select the store flavor once, the address loops below only issue stores
+	if (writeType == 1 && mSize == 4) {
+		uint32_t pattern = mPattern & 0xFFFFFFFF;
+		for (uint64_t idx = 0; idx < entries; idx++) {
+			uint64_t addr = list[idx] + mOffset;
 			asm volatile ("movnti %0, (%1)" :
 							: "r"(pattern), "r"(addr)
 							: "memory");
-		} else if (writeType == 2 && mSize == 8) {
-			uint64_t pattern;
-			pattern = (((mPattern << 32UL) & 0xFFFFFFFFFFFFFFFF) | (mPattern & 0xFFFFFFFF));
+		}
+	} else if (writeType == 2 && mSize == 8) {
+		uint64_t pattern = (((mPattern << 32UL) & 0xFFFFFFFFFFFFFFFF) | (mPattern & 0xFFFFFFFF));
+		for (uint64_t idx = 0; idx < entries; idx++) {
+			uint64_t addr = list[idx] + mOffset;
 			asm volatile ("movq %0, (%1)"   :
 							: "r"(pattern), "r"(addr)
 							: "memory");
-		} else if (writeType == 2 && mSize == 4) {
-			uint32_t pattern = mPattern & 0xFFFFFFFF;
+		}
+	} else if (writeType == 2 && mSize == 4) {
+		uint32_t pattern = mPattern & 0xFFFFFFFF;
+		for (uint64_t idx = 0; idx < entries; idx++) {
+			uint64_t addr = list[idx] + mOffset;
 			asm volatile ("movl %0, (%1)"   :
 							: "r"(pattern), "r"(addr)
 							: "memory");
-		} else if (writeType == 2 && mSize == 2) {
-			uint16_t pattern = mPattern & 0xFFFF;
+		}
+	} else if (writeType == 2 && mSize == 2) {
+		uint16_t pattern = mPattern & 0xFFFF;
+		for (uint64_t idx = 0; idx < entries; idx++) {
+			uint64_t addr = list[idx] + mOffset;
 			asm volatile ("movw %0, (%1)"  :
 							: "r"(pattern), "r"(addr)
 							: "memory");
-		} else if (writeType == 2 && mSize == 1) {
-			uint8_t pattern = mPattern & 0xFF;
+		}
+	} else if (writeType == 2 && mSize == 1) {
+		uint8_t pattern = mPattern & 0xFF;
+		for (uint64_t idx = 0; idx < entries; idx++) {
+			uint64_t addr = list[idx] + mOffset;
 			asm volatile ("movb %0, (%1)" :
 							: "r"(pattern), "r"(addr)
 							: "memory");
-		} else {
-			ss << "Do nothing for 0x" << std::hex << addr <<  std::endl;
-			mLogger->print(ss.str(), 2);
 		}
-		ss.str(std::string());
+	} else {
+		std::stringstream ss;
+		for (uint64_t idx = 0; idx < entries; idx++) {
+			ss << "Do nothing for 0x" << std::hex << (list[idx] + mOffset) <<  std::endl;
+		}
+		mLogger->print(ss.str(), 2);
 	}
 }
 
 inline ret_t MulWrStreamNew::ReadStage()
 {
-	uint64_t addr;
+	const uint64_t *list = mpAddrList->GetListPtr();
+	const uint64_t entries = mpAddrList->GetEntrySize();
 	uint8_t readType = (mParams & 0xF000) >> 12;
+	std::stringstream ss;
 
 	if (readType == 0) return 0;
 
-	for (uint32_t idx = 0; idx < mpAddrList->GetEntrySize(); idx++) {
-		addr = (*mpAddrList)[idx] + mOffset;
-		std::stringstream ss;
-		if (readType == 2 && mSize == 8) {
+	// Select the load flavor once, mismatches are formatted only on the error path
+	if (readType == 2 && mSize == 8) {
+		uint64_t pattern = (((mPattern << 32UL) & 0xFFFFFFFFFFFFFFFF) | (mPattern & 0xFFFFFFFF));
+		for (uint64_t idx = 0; idx < entries; idx++) {
+			uint64_t addr = list[idx] + mOffset;
 			uint64_t readPattern;
 			asm volatile ("movq (%1), %0"   : "=r"(readPattern)
 							: "r"(addr)
 							: "memory");
-			uint64_t pattern = (((mPattern << 32UL) & 0xFFFFFFFFFFFFFFFF) | (mPattern & 0xFFFFFFFF));
 			if (readPattern != pattern) {
 				//throw std::runtime_error("Value mismatch.");
 				ss << "Value mismatch in MOVQ. ReadPattern=0x"<< std::hex << readPattern << ", ExpectedPattern=0x" <<
-					mPattern << std::endl;
+					mPattern << ", " << CxlAddressMap::build()->describe(addr) << std::endl;
 				mLogger->report_failure(ss.str());
 				return -1;
 			}
-		} else if (readType == 2 && mSize == 4) {
+		}
+	} else if (readType == 2 && mSize == 4) {
+		uint32_t pattern = mPattern & 0xFFFFFFFF;
+		for (uint64_t idx = 0; idx < entries; idx++) {
+			uint64_t addr = list[idx] + mOffset;
 			uint32_t readPattern;
 			asm volatile ("movl (%1), %0"   : "=r"(readPattern)
 							: "r"(addr)
 							: "memory");
-			if (readPattern != (mPattern & 0xFFFFFFFF)) {
+			if (readPattern != pattern) {
 				ss << "Value mismatch in MOVL. ReadPattern=0x" << std::hex << readPattern << ", ExpectedPattern=0x" <<
-					(mPattern & 0xFFFFFFFF) << std::endl;
+					pattern << ", " << CxlAddressMap::build()->describe(addr) << std::endl;
 				mLogger->report_failure(ss.str());
 				return -1;
 			}
-		} else if (readType == 2 && mSize == 2) {
+		}
+	} else if (readType == 2 && mSize == 2) {
+		uint16_t pattern = mPattern & 0xFFFF;
+		for (uint64_t idx = 0; idx < entries; idx++) {
+			uint64_t addr = list[idx] + mOffset;
 			uint16_t readPattern;
 			asm volatile ("movw (%1), %0"   : "=r"(readPattern)
 							: "r"(addr)
 							: "memory");
-			if (readPattern != (mPattern & 0xFFFF)) {
+			if (readPattern != pattern) {
 				ss << "Value mismatch in MOVW. ReadPattern=0x" << std::hex << readPattern << ", ExpectedPattern=0x" <<
-					(mPattern & 0xFFFF) << std::endl;
+					pattern << ", " << CxlAddressMap::build()->describe(addr) << std::endl;
 				mLogger->report_failure(ss.str());
 				return -1;
 			}
-		} else if (readType == 2 && mSize == 1) {
+		}
+	} else if (readType == 2 && mSize == 1) {
+		uint8_t pattern = mPattern & 0xFF;
+		for (uint64_t idx = 0; idx < entries; idx++) {
+			uint64_t addr = list[idx] + mOffset;
 			uint8_t readPattern;
 			asm volatile ("movb (%1), %0"   : "=r"(readPattern)
 							: "r"(addr)
 							: "memory");
-			if (readPattern != (mPattern & 0xFF)) {
-				ss << "Value mismatch in MOVB. ReadPattern=0x" << std::hex << readPattern << ", ExpectedPattern=0x" <<
-				(uint16_t)(mPattern & 0xFF) << std::endl;
+			if (readPattern != pattern) {
+				ss << "Value mismatch in MOVB. ReadPattern=0x" << std::hex << (uint16_t)readPattern << ", ExpectedPattern=0x" <<
+				(uint16_t)pattern << ", " << CxlAddressMap::build()->describe(addr) << std::endl;
 				mLogger->report_failure(ss.str());
 				return -1;
 			}
-		} else {
-			ss << "Do nothing for 0x" << std::hex << addr << std::endl;
-			mLogger->print(ss.str(), 2);
-			return -1;
 		}
-		ss.str(std::string());
+	} else {
+		ss << "Do nothing for 0x" << std::hex << (list[0] + mOffset) << std::endl;
+		mLogger->print(ss.str(), 2);
+		return -1;
 	}
 	return 0;
 }
@@ -161,6 +190,11 @@ MulWrStreamNew::MulWrStreamNew(uint32_t params, uint64_t pattern, uint8_t offset
 	mSize = size;
 }
 
+MulWrStreamNew::MulWrStreamNew(const AlgoConfig& config) :
+	MulWrStreamNew(config.params, config.pattern, config.offset, config.size)
+{
+}
+
 uint8_t MulWrStreamNew::GetOffset()
 {
 	return mOffset;
@@ -171,32 +205,59 @@ uint8_t MulWrStreamNew::GetSize()
 	return mSize;
 }
 
+uint64_t MulWrStreamNew::get_bytes_per_run()
+{
+	uint64_t stages = 0;
+
+	if (mParams & 0xF0) stages++;
+	if (mParams & 0xF000) stages++;
+
+	return stages * mpAddrList->GetEntrySize() * mSize;
+}
+
+uint64_t MulWrStreamNew::get_accesses_per_run()
+{
+	uint64_t stages = 0;
+
+	if (mParams & 0xF) stages++;
+	if (mParams & 0xF0) stages++;
+	if (mParams & 0xF00) stages++;
+	if (mParams & 0xF000) stages++;
+
+	return stages * mpAddrList->GetEntrySize();
+}
+
 ret_t MulWrStreamNew::run()
 {
 	ret_t retCode = 0;
 	uint8_t flushType, writeType, readType;
+	uint64_t spanBegin = SpanBegin();
 
 	// CLFlush stage
 	flushType = mParams & 0xF;
 	if (flushType) {
 		FlushStage();
+		SpanEnd(TimelineSpanFlush, spanBegin);
 	}
 	// Write stage
 	writeType = (mParams & 0xF0) >> 4;
 	if (writeType != 0) {
 		WriteStage();
+		SpanEnd(TimelineSpanWrite, spanBegin);
 	}
 
 	// CLFlush stage
 	flushType = (mParams & 0xF00) >> 8;
 	if (flushType) {
 		FlushStage();
+		SpanEnd(TimelineSpanFlush, spanBegin);
 	}
 
 	// Read stage
 	readType = (mParams & 0xF000) >> 12;
 	if (readType) {
 		retCode = ReadStage();
+		SpanEnd(TimelineSpanRead, spanBegin);
 	}
 
 	return retCode;
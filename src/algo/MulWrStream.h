@@ -88,6 +88,13 @@ class MulWrStreamNew : public IAlgorithm
 		 */
 		MulWrStreamNew(uint32_t params, uint64_t pattern, uint8_t offset, uint8_t size);
 
+		/**
+		 * @brief Constructs a new MulWrStreamNew object from thread parameters.
+		 *
+		 * @param config Thread parameters, uses params, pattern, offset and size.
+		 */
+		MulWrStreamNew(const AlgoConfig& config);
+
 		/**
 		 * @brief 
 		 * 
@@ -105,6 +112,16 @@ class MulWrStreamNew : public IAlgorithm
 		 */
 		uint64_t get_operation_size(void) { return 0x4; }
 
+		/**
+		 * @return Bytes moved by the write and read stages enabled in mParams.
+		 */
+		uint64_t get_bytes_per_run(void);
+
+		/**
+		 * @return Accesses issued by all flush, write and read stages enabled in mParams.
+		 */
+		uint64_t get_accesses_per_run(void);
+
 		/**
 		 * @brief Runs write stage (further description needed)
 		 */
@@ -0,0 +1,133 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+
+#include <x86intrin.h>
+
+#include "PingPong.h"
+#include "Primitives.h"
+
+// Spins between two timeout checks
+#define PINGPONG_SPINS_PER_CHECK   1024
+
+/* Measures the TSC rate against the steady clock. */
+static double calibrate_tsc(void)
+{
+	auto begin = std::chrono::steady_clock::now();
+	uint64_t tsc_begin = __rdtsc();
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	uint64_t tsc_end = __rdtsc();
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+	return (double)(tsc_end - tsc_begin) / elapsed;
+}
+
+PingPong::PingPong(const AlgoConfig& config)
+{
+	auto hwid = config.options.find("hwid");
+	auto peer = config.options.find("peer");
+	if (hwid == config.options.end() || peer == config.options.end() || hwid->second == peer->second) {
+		mLogger->report_failure("PingPong algorithm requires --peer=hwid of another core thread.");
+		exit(0);
+	}
+	mInitiator = std::stoull(hwid->second) < std::stoull(peer->second);
+
+	mOffset = config.offset;
+	if (mOffset + 0x8 > CACHELINE_SIZE) {
+		mLogger->report_failure("PingPong sequence number at --offset=" + std::to_string(mOffset) + " crosses a cache line.");
+		exit(0);
+	}
+
+	mHistogram.assign(PINGPONG_BUCKETS + 1, 0);
+	mTscPerNs = calibrate_tsc();
+}
+
+bool PingPong::WaitFor(uint64_t addr, uint64_t value)
+{
+	uint64_t begin = __rdtsc();
+	uint64_t timeout = PINGPONG_TIMEOUT_NS * mTscPerNs;
+
+	while (true) {
+		for (uint32_t spin = 0; spin < PINGPONG_SPINS_PER_CHECK; spin++) {
+			if (primitive_read(addr, 8) == value) {
+				return true;
+			}
+		}
+		if (__rdtsc() - begin > timeout) {
+			return false;
+		}
+	}
+}
+
+void PingPong::Record(uint64_t tsc)
+{
+	uint64_t ns = tsc / mTscPerNs;
+	mHistogram[std::min<uint64_t>(ns / PINGPONG_BUCKET_NS, PINGPONG_BUCKETS)]++;
+	mMinNs = std::min(mMinNs, ns);
+	mMaxNs = std::max(mMaxNs, ns);
+	mRounds++;
+}
+
+ret_t PingPong::run()
+{
+	uint64_t addr = mpAddrList->GetListPtr()[0] + mOffset;
+
+	for (uint32_t round = 0; round < PINGPONG_ROUNDS_PER_RUN; round++) {
+		if (mInitiator) {
+			// A send left unanswered by a timeout is still in flight, keep waiting for it
+			if (!mWaiting) {
+				mSendTsc = __rdtsc();
+				primitive_write(addr, mSeq + 1, 8);
+				mWaiting = true;
+			}
+			if (!this->WaitFor(addr, mSeq + 2)) {
+				return ALGO_RUN_RETRY;
+			}
+			this->Record(__rdtsc() - mSendTsc);
+			mWaiting = false;
+		} else {
+			if (!this->WaitFor(addr, mSeq + 1)) {
+				return ALGO_RUN_RETRY;
+			}
+			primitive_write(addr, mSeq + 2, 8);
+		}
+		mSeq += 2;
+	}
+	return 0;
+}
+
+double PingPong::get_percentile(double percentile)
+{
+	if (mRounds == 0) {
+		return 0;
+	}
+	uint64_t rank = (mRounds * percentile) / 100.0;
+	uint64_t count = 0;
+	for (uint32_t bucket = 0; bucket <= PINGPONG_BUCKETS; bucket++) {
+		count += mHistogram[bucket];
+		if (count > rank) {
+			// Middle of the bucket, the overflow bucket reports the maximum
+			return (bucket == PINGPONG_BUCKETS) ? mMaxNs : (bucket + 0.5) * PINGPONG_BUCKET_NS;
+		}
+	}
+	return mMaxNs;
+}
+
+std::string PingPong::get_report()
+{
+	if (!mInitiator || mRounds == 0) {
+		return "";
+	}
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(1) << "round trips: " << mRounds << ", ns min/p50/p90/p99/p99.9/max: "
+	   << mMinNs << "/" << this->get_percentile(50) << "/" << this->get_percentile(90) << "/"
+	   << this->get_percentile(99) << "/" << this->get_percentile(99.9) << "/" << mMaxNs;
+	return ss.str();
+}
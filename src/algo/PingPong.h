@@ -0,0 +1,103 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <string>
+#include <vector>
+
+#include "IAlgorithm.h"
+
+// Round trips issued by a single run() call
+#define PINGPONG_ROUNDS_PER_RUN    256
+// Latency histogram, 10 ns buckets up to 10 us and one overflow bucket
+#define PINGPONG_BUCKET_NS         10
+#define PINGPONG_BUCKETS           1000
+// run() gives up waiting for the peer after this long so the generator can stop
+#define PINGPONG_TIMEOUT_NS        10000000ULL
+
+/**
+ * @class PingPong
+ * @brief Two-party cache line ping-pong between a thread and its --peer.
+ * Both threads use the first line of their target, the sequence number sits at --offset.
+ * The lower hw id sends odd sequence numbers and measures the round trip until the peer
+ * answers with the next even number.
+ */
+class PingPong : public IAlgorithm
+{
+	private:
+		bool mInitiator;
+		uint8_t mOffset;
+		uint64_t mSeq = 0;
+		bool mWaiting = false;
+		uint64_t mSendTsc = 0;
+		double mTscPerNs;
+
+		std::vector<uint64_t> mHistogram;
+		uint64_t mRounds = 0;
+		uint64_t mMinNs = UINT64_MAX;
+		uint64_t mMaxNs = 0;
+
+		/**
+		 * @brief Spins until the line holds value.
+		 * @return false if the peer did not answer within PINGPONG_TIMEOUT_NS.
+		 */
+		bool WaitFor(uint64_t addr, uint64_t value);
+
+		/**
+		 * @brief Adds one round trip to the histogram.
+		 */
+		void Record(uint64_t tsc);
+
+	public:
+		/**
+		 * @brief Exits the test if --peer is missing or the sequence number crosses a line.
+		 *
+		 * @param config Thread parameters, uses offset and the --hwid and --peer switches.
+		 */
+		PingPong(const AlgoConfig& config);
+
+		/**
+		 * @brief Runs PINGPONG_ROUNDS_PER_RUN exchanges, returns early if the peer stops answering.
+		 */
+		ret_t run(void);
+
+		/**
+		 * @return uint64_t 0x0
+		 */
+		ret_t verify(void) { return 0x0; }
+
+		/**
+		 * @return 0x8, size of the sequence number.
+		 */
+		uint64_t get_operation_size(void) { return 0x8; }
+
+		/**
+		 * @return Bytes of the sequence number written and read back per run.
+		 */
+		uint64_t get_bytes_per_run(void) { return PINGPONG_ROUNDS_PER_RUN * 0x8 * 2; }
+
+		/**
+		 * @return PINGPONG_ROUNDS_PER_RUN, phase latency is the round trip time.
+		 */
+		uint64_t get_accesses_per_run(void) { return PINGPONG_ROUNDS_PER_RUN; }
+
+		/**
+		 * @return Round trip latency distribution, empty for the answering side.
+		 */
+		std::string get_report(void);
+
+		/**
+		 * @return Round trips measured so far.
+		 */
+		uint64_t get_rounds(void) { return mRounds; }
+
+		/**
+		 * @param percentile 0 to 100.
+		 * @return Round trip latency in ns at the given percentile, bucket resolution.
+		 */
+		double get_percentile(double percentile);
+};
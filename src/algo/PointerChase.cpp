@@ -0,0 +1,63 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <random>
+#include <numeric>
+#include <algorithm>
+
+#include "PointerChase.h"
+
+PointerChase::PointerChase(const AlgoConfig& config)
+{
+	mOffset = config.offset;
+	if (mOffset + sizeof(uint64_t) > CACHELINE_SIZE) {
+		mLogger->report_failure("Chase needs --offset to leave 8 bytes in the line.");
+		exit(0);
+	}
+}
+
+void PointerChase::setAddressList(std::shared_ptr<AddressList> pAddrList)
+{
+	IAlgorithm::setAddressList(std::move(pAddrList));
+	mLinked = false;
+}
+
+void PointerChase::Link()
+{
+	uint64_t entries = mpAddrList->GetEntrySize();
+	const uint64_t *list = mpAddrList->GetListPtr();
+	std::vector<uint64_t> order(entries);
+	std::iota(order.begin(), order.end(), 0);
+	std::shuffle(order.begin(), order.end(), std::mt19937_64(CHASE_SEED));
+
+	// Last line links back to the first, the chain is a single cycle over every line
+	for (uint64_t idx = 0; idx < entries; idx++) {
+		uint64_t line = list[order[idx]] + mOffset;
+		uint64_t next = list[order[(idx + 1) % entries]] + mOffset;
+		*(volatile uint64_t*)line = next;
+	}
+	mStart = list[order[0]] + mOffset;
+	mLinked = true;
+}
+
+ret_t PointerChase::run()
+{
+	if (!mLinked) {
+		this->Link();
+	}
+
+	uint64_t entries = mpAddrList->GetEntrySize();
+	uint64_t cursor = mStart;
+	for (uint64_t idx = 0; idx < entries; idx++) {
+		cursor = *(volatile uint64_t*)cursor;
+	}
+	if (cursor != mStart) {
+		mLogger->report_failure("Chase chain broken, another thread wrote to its lines.");
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,74 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <vector>
+
+#include "IAlgorithm.h"
+
+// Seed of the chain order, fixed so every run walks the same chain
+#define CHASE_SEED    0x43584c
+
+/**
+ * @class PointerChase
+ * @brief Dependent loads over the lines of the address list, visited in a random cyclic order.
+ * Every line holds the address of the next one at --offset, so each load waits for the previous one
+ * and neither the prefetchers nor out of order execution hide the load-to-use latency.
+ * The chain is written by the first run(), after the test cleared the targets. Threads writing to the
+ * same lines break it, run() then fails.
+ */
+class PointerChase : public IAlgorithm
+{
+	private:
+		uint8_t mOffset;
+		uint64_t mStart = 0;
+		bool mLinked = false;
+
+		/**
+		 * @brief Links the address list lines into a single random cycle, overwriting the target memory.
+		 */
+		void Link(void);
+
+	public:
+		/**
+		 * @brief Validates the link placement. Exits the test when a link would cross its line.
+		 *
+		 * @param config Thread parameters, uses offset.
+		 */
+		PointerChase(const AlgoConfig& config);
+
+		/**
+		 * @brief Sets the address list, the next run() links its lines again.
+		 */
+		void setAddressList(std::shared_ptr<AddressList> pAddrList);
+
+		/**
+		 * @brief Follows the chain once around, one load per address list entry.
+		 * @return 0, or -1 when the chain did not lead back to its first line.
+		 */
+		ret_t run(void);
+
+		/**
+		 * @return uint64_t 0x0
+		 */
+		ret_t verify(void) { return 0x0; }
+
+		/**
+		 * @return Link size, 8 bytes.
+		 */
+		uint64_t get_operation_size(void) { return sizeof(uint64_t); }
+
+		/**
+		 * @return Bytes loaded per pass over the chain.
+		 */
+		uint64_t get_bytes_per_run(void) { return this->get_accesses_per_run() * sizeof(uint64_t); }
+
+		/**
+		 * @return Dependent loads per pass, one per address list entry.
+		 */
+		uint64_t get_accesses_per_run(void) { return mpAddrList ? mpAddrList->GetEntrySize() : 0; }
+};
@@ -0,0 +1,139 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+
+#include "cxl/CxlTypes.h"
+
+/**
+ * @brief Single access primitives shared by the algorithms, same instructions MulWrStreamNew issues.
+ * Size is the access width in bytes (1, 2, 4 or 8), other sizes are ignored.
+ */
+
+/**
+ * @brief Stores the low size bytes of pattern at addr with a temporal store.
+ */
+static inline void primitive_write(uint64_t addr, uint64_t pattern, uint8_t size)
+{
+	switch (size) {
+	case 8:
+		asm volatile ("movq %0, (%1)" : : "r"(pattern), "r"(addr) : "memory");
+		break;
+	case 4:
+		asm volatile ("movl %0, (%1)" : : "r"((uint32_t)pattern), "r"(addr) : "memory");
+		break;
+	case 2:
+		asm volatile ("movw %0, (%1)" : : "r"((uint16_t)pattern), "r"(addr) : "memory");
+		break;
+	case 1:
+		asm volatile ("movb %0, (%1)" : : "q"((uint8_t)pattern), "r"(addr) : "memory");
+		break;
+	}
+}
+
+/**
+ * @brief Stores the low size bytes of pattern at addr with a non-temporal store (4 or 8 bytes).
+ */
+static inline void primitive_write_nt(uint64_t addr, uint64_t pattern, uint8_t size)
+{
+	if (size == 8) {
+		asm volatile ("movnti %0, (%1)" : : "r"(pattern), "r"(addr) : "memory");
+	} else {
+		asm volatile ("movnti %0, (%1)" : : "r"((uint32_t)pattern), "r"(addr) : "memory");
+	}
+}
+
+/**
+ * @brief Loads size bytes from addr.
+ * @return Loaded value, zero extended.
+ */
+static inline uint64_t primitive_read(uint64_t addr, uint8_t size)
+{
+	uint64_t value = 0;
+	switch (size) {
+	case 8:
+		asm volatile ("movq (%1), %0" : "=r"(value) : "r"(addr) : "memory");
+		break;
+	case 4: {
+		uint32_t read;
+		asm volatile ("movl (%1), %0" : "=r"(read) : "r"(addr) : "memory");
+		value = read;
+		break;
+	}
+	case 2: {
+		uint16_t read;
+		asm volatile ("movw (%1), %0" : "=r"(read) : "r"(addr) : "memory");
+		value = read;
+		break;
+	}
+	case 1: {
+		uint8_t read;
+		asm volatile ("movb (%1), %0" : "=q"(read) : "r"(addr) : "memory");
+		value = read;
+		break;
+	}
+	}
+	return value;
+}
+
+/**
+ * @brief Flushes the cache line holding addr.
+ */
+static inline void primitive_flush(uint64_t addr)
+{
+	asm volatile ("clflush (%0)" :: "r"(addr) : "memory");
+}
+
+/**
+ * @brief lock xadd of value at addr (4 or 8 bytes).
+ * @return Value held at addr before the addition.
+ */
+static inline uint64_t primitive_xadd(uint64_t addr, uint64_t value, uint8_t size)
+{
+	if (size == 8) {
+		asm volatile ("lock xaddq %0, (%1)" : "+r"(value) : "r"(addr) : "memory", "cc");
+		return value;
+	}
+	uint32_t value32 = value;
+	asm volatile ("lock xaddl %0, (%1)" : "+r"(value32) : "r"(addr) : "memory", "cc");
+	return value32;
+}
+
+/**
+ * @brief lock cmpxchg at addr (4 or 8 bytes).
+ * @param expected Value compared with addr, updated with the value found there.
+ * @return true if desired was stored.
+ */
+static inline bool primitive_cmpxchg(uint64_t addr, uint64_t& expected, uint64_t desired, uint8_t size)
+{
+	bool stored;
+	if (size == 8) {
+		asm volatile ("lock cmpxchgq %3, (%2)\n\tsete %1" : "+a"(expected), "=q"(stored)
+					  : "r"(addr), "r"(desired) : "memory", "cc");
+		return stored;
+	}
+	uint32_t expected32 = expected;
+	asm volatile ("lock cmpxchgl %3, (%2)\n\tsete %1" : "+a"(expected32), "=q"(stored)
+				  : "r"(addr), "r"((uint32_t)desired) : "memory", "cc");
+	expected = expected32;
+	return stored;
+}
+
+/**
+ * @brief xchg at addr (4 or 8 bytes), locked implicitly by the processor.
+ * @return Value held at addr before the exchange.
+ */
+static inline uint64_t primitive_xchg(uint64_t addr, uint64_t value, uint8_t size)
+{
+	if (size == 8) {
+		asm volatile ("xchgq %0, (%1)" : "+r"(value) : "r"(addr) : "memory");
+		return value;
+	}
+	uint32_t value32 = value;
+	asm volatile ("xchgl %0, (%1)" : "+r"(value32) : "r"(addr) : "memory");
+	return value32;
+}
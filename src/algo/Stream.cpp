@@ -0,0 +1,139 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+
+#include <emmintrin.h>
+
+#include "Stream.h"
+
+extern "C"
+{
+    #include <numa.h>
+}
+
+static const char* stream_kernel_names[] = {"copy", "scale", "add", "triad"};
+static const char* stream_store_names[] = {"temporal", "nt", "movsb"};
+
+/* Memory only nodes have no cpus, that is how CXL memory expanders show up. */
+static std::string node_kind(uint64_t node)
+{
+	struct bitmask* cpus = numa_allocate_cpumask();
+	bool cpuless = (numa_node_to_cpus(node, cpus) == 0) && (numa_bitmask_weight(cpus) == 0);
+	numa_free_cpumask(cpus);
+	return cpuless ? "CXL" : "DRAM";
+}
+
+Stream::Stream(const AlgoConfig& config, uint8_t kernel)
+{
+	mKernel = kernel;
+	uint64_t sources = (kernel == STREAM_KERNEL_ADD || kernel == STREAM_KERNEL_TRIAD) ? 2 : 1;
+	if (config.sources.size() != sources) {
+		mLogger->report_failure("Stream " + std::string(stream_kernel_names[kernel]) + " requires --target=dst" +
+								(sources == 2 ? ",src,src." : ",src."));
+		exit(0);
+	}
+
+	mStore = STREAM_STORE_TEMPORAL;
+	auto store = config.options.find("stream-store");
+	if (store != config.options.end()) {
+		if (store->second == "nt") {
+			mStore = STREAM_STORE_NT;
+		} else if (store->second == "movsb" && kernel == STREAM_KERNEL_COPY) {
+			mStore = STREAM_STORE_MOVSB;
+		} else if (store->second != "temporal") {
+			mLogger->report_failure("Unsupported --stream-store=" + store->second + " for stream " + stream_kernel_names[kernel] + ".");
+			exit(0);
+		}
+	}
+
+	mpA = (double*)config.target_address;
+	mpB = (const double*)config.sources[0].address;
+	mpC = (const double*)config.sources.back().address;
+	mLength = config.target_size;
+	for (auto & source : config.sources) {
+		mLength = std::min(mLength, source.size);
+	}
+	mLength &= ~(uint64_t)(CACHELINE_SIZE - 1);
+	mChunk = std::min<uint64_t>(STREAM_CHUNK_SIZE, mLength);
+
+	// e.g. DRAM->CXL, add and triad list both sources
+	std::string from = node_kind(config.sources[0].node);
+	if (sources == 2 && node_kind(config.sources[1].node) != from) {
+		from += "+" + node_kind(config.sources[1].node);
+	}
+	mDirection = from + "->" + node_kind(config.target_node);
+}
+
+uint64_t Stream::get_bytes_per_run()
+{
+	uint64_t arrays = (mKernel == STREAM_KERNEL_ADD || mKernel == STREAM_KERNEL_TRIAD) ? 3 : 2;
+	return arrays * mChunk;
+}
+
+ret_t Stream::run()
+{
+	auto begin = std::chrono::steady_clock::now();
+	uint64_t first = mCursor / sizeof(double);
+	uint64_t count = mChunk / sizeof(double);
+	double* a = mpA + first;
+	const double* b = mpB + first;
+	const double* c = mpC + first;
+	const __m128d scalar = _mm_set1_pd(STREAM_SCALAR);
+
+	// Select kernel and store flavor once, a cache line per iteration
+	if (mStore == STREAM_STORE_MOVSB) {
+		void* dst = a;
+		const void* src = b;
+		uint64_t bytes = mChunk;
+		asm volatile ("rep movsb" : "+D"(dst), "+S"(src), "+c"(bytes) : : "memory");
+	} else if (mKernel == STREAM_KERNEL_COPY) {
+		for (uint64_t idx = 0; idx < count; idx += 2) {
+			__m128d value = _mm_load_pd(b + idx);
+			if (mStore == STREAM_STORE_NT) _mm_stream_pd(a + idx, value);
+			else _mm_store_pd(a + idx, value);
+		}
+	} else if (mKernel == STREAM_KERNEL_SCALE) {
+		for (uint64_t idx = 0; idx < count; idx += 2) {
+			__m128d value = _mm_mul_pd(scalar, _mm_load_pd(b + idx));
+			if (mStore == STREAM_STORE_NT) _mm_stream_pd(a + idx, value);
+			else _mm_store_pd(a + idx, value);
+		}
+	} else if (mKernel == STREAM_KERNEL_ADD) {
+		for (uint64_t idx = 0; idx < count; idx += 2) {
+			__m128d value = _mm_add_pd(_mm_load_pd(b + idx), _mm_load_pd(c + idx));
+			if (mStore == STREAM_STORE_NT) _mm_stream_pd(a + idx, value);
+			else _mm_store_pd(a + idx, value);
+		}
+	} else {
+		for (uint64_t idx = 0; idx < count; idx += 2) {
+			__m128d value = _mm_add_pd(_mm_load_pd(b + idx), _mm_mul_pd(scalar, _mm_load_pd(c + idx)));
+			if (mStore == STREAM_STORE_NT) _mm_stream_pd(a + idx, value);
+			else _mm_store_pd(a + idx, value);
+		}
+	}
+	if (mStore == STREAM_STORE_NT) {
+		_mm_sfence();
+	}
+
+	mCursor = (mCursor + mChunk + mChunk <= mLength) ? mCursor + mChunk : 0;
+	mBytes += this->get_bytes_per_run();
+	mElapsedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+	return 0;
+}
+
+std::string Stream::get_report()
+{
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(2) << "stream " << stream_kernel_names[mKernel] << " ("
+	   << stream_store_names[mStore] << " stores) " << mDirection << ": "
+	   << ((mElapsedNs > 0) ? (double)mBytes / mElapsedNs : 0) << " GB/s sustained";
+	return ss.str();
+}
@@ -0,0 +1,126 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <string>
+
+#include "IAlgorithm.h"
+
+// Bytes of the destination array processed by a single run() call
+#define STREAM_CHUNK_SIZE    0x200000
+// Scalar of scale and triad, same as STREAM
+#define STREAM_SCALAR        3.0
+
+#define STREAM_KERNEL_COPY     0
+#define STREAM_KERNEL_SCALE    1
+#define STREAM_KERNEL_ADD      2
+#define STREAM_KERNEL_TRIAD    3
+
+#define STREAM_STORE_TEMPORAL  0
+#define STREAM_STORE_NT        1
+#define STREAM_STORE_MOVSB     2
+
+/**
+ * @class Stream
+ * @brief STREAM copy, scale, add and triad kernels on double arrays spread over targets.
+ * The first target of --target=dst,src[,src] holds the destination array a, the following ones
+ * the source arrays b and c. Arrays span the smallest of the targets and are processed in
+ * STREAM_CHUNK_SIZE pieces, wrapping at the end.
+ * --stream-store=temporal (default), nt for non-temporal stores, or movsb (copy only) for rep movsb.
+ */
+class Stream : public IAlgorithm
+{
+	private:
+		uint8_t mKernel;
+		uint8_t mStore;
+		double* mpA;
+		const double* mpB;
+		const double* mpC;
+		uint64_t mLength;
+		uint64_t mChunk;
+		uint64_t mCursor = 0;
+		std::string mDirection;
+
+		uint64_t mBytes = 0;
+		uint64_t mElapsedNs = 0;
+
+	protected:
+		/**
+		 * @brief Resolves arrays and store flavor. Exits the test if sources are missing.
+		 *
+		 * @param config Thread parameters, uses targets, sources and --stream-store.
+		 * @param kernel One of the STREAM_KERNEL_ values.
+		 */
+		Stream(const AlgoConfig& config, uint8_t kernel);
+
+	public:
+		/**
+		 * @brief Runs the kernel over the next chunk of the arrays.
+		 */
+		ret_t run(void);
+
+		/**
+		 * @return uint64_t 0x0
+		 */
+		ret_t verify(void) { return 0x0; }
+
+		/**
+		 * @return 0x8, size of an array element.
+		 */
+		uint64_t get_operation_size(void) { return 0x8; }
+
+		/**
+		 * @return Array bytes read and written per chunk, counted as STREAM does (no write allocate).
+		 */
+		uint64_t get_bytes_per_run(void);
+
+		/**
+		 * @return Cache lines read and written per chunk.
+		 */
+		uint64_t get_accesses_per_run(void) { return this->get_bytes_per_run() / CACHELINE_SIZE; }
+
+		/**
+		 * @return Direction between memory kinds and sustained GB/s while the kernel ran.
+		 */
+		std::string get_report(void);
+};
+
+/**
+ * @class StreamCopy
+ */
+class StreamCopy : public Stream
+{
+	public:
+		StreamCopy(const AlgoConfig& config) : Stream(config, STREAM_KERNEL_COPY) {}
+};
+
+/**
+ * @class StreamScale
+ */
+class StreamScale : public Stream
+{
+	public:
+		StreamScale(const AlgoConfig& config) : Stream(config, STREAM_KERNEL_SCALE) {}
+};
+
+/**
+ * @class StreamAdd
+ */
+class StreamAdd : public Stream
+{
+	public:
+		StreamAdd(const AlgoConfig& config) : Stream(config, STREAM_KERNEL_ADD) {}
+};
+
+/**
+ * @class StreamTriad
+ */
+class StreamTriad : public Stream
+{
+	public:
+		StreamTriad(const AlgoConfig& config) : Stream(config, STREAM_KERNEL_TRIAD) {}
+};
@@ -0,0 +1,185 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <cstring>
+#include <algorithm>
+
+#include <x86intrin.h>
+
+#include "TraceReplay.h"
+#include "Primitives.h"
+
+extern "C"
+{
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+}
+
+TraceReplay::TraceReplay(const AlgoConfig& config)
+{
+	auto trace = config.options.find("trace");
+	if (trace == config.options.end()) {
+		mLogger->report_failure("Trace algorithm requires --trace=file.");
+		exit(0);
+	}
+	auto timing = config.options.find("trace-timing");
+	mTiming = (timing != config.options.end()) && (timing->second != "0");
+
+	// Same pattern widening as MulWrStreamNew::WriteStage()
+	mPattern = (((config.pattern << 32UL) & 0xFFFFFFFFFFFFFFFF) | (config.pattern & 0xFFFFFFFF));
+	mTargetAddress = config.target_address;
+	mTargetSize = config.target_size;
+
+	struct stat file_stat;
+	mFd = open(trace->second.c_str(), O_RDONLY);
+	if (mFd < 0 || fstat(mFd, &file_stat) != 0 || (uint64_t)file_stat.st_size < sizeof(TraceHeader)) {
+		mLogger->report_failure("Unable to open trace " + trace->second + ".");
+		exit(0);
+	}
+	mFileSize = file_stat.st_size;
+
+	TraceHeader header;
+	if (pread(mFd, &header, sizeof(header), 0) != sizeof(header) ||
+		memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+		header.version != TRACE_VERSION || header.record_size != sizeof(TraceRecord)) {
+		mLogger->report_failure(trace->second + " is not a version " + std::to_string(TRACE_VERSION) + " trace.");
+		exit(0);
+	}
+	mNumRecords = header.num_records;
+	if (mNumRecords == 0 || sizeof(TraceHeader) + mNumRecords * sizeof(TraceRecord) > mFileSize) {
+		mLogger->report_failure("Trace " + trace->second + " is empty or truncated.");
+		exit(0);
+	}
+
+	this->ScanTrace(trace->second);
+}
+
+TraceReplay::~TraceReplay()
+{
+	if (mpWindow != nullptr) {
+		munmap((void*)mpWindow, mWindowLength);
+	}
+	if (mFd >= 0) {
+		close(mFd);
+	}
+}
+
+const TraceRecord* TraceReplay::MapRecords(uint64_t idx, uint64_t& count)
+{
+	uint64_t position = sizeof(TraceHeader) + idx * sizeof(TraceRecord);
+
+	if (mpWindow == nullptr || position < mWindowStart || position + sizeof(TraceRecord) > mWindowStart + mWindowLength) {
+		if (mpWindow != nullptr) {
+			munmap((void*)mpWindow, mWindowLength);
+		}
+		// Header and records are 16 byte aligned, a record never straddles two windows
+		mWindowStart = position & ~(uint64_t)(TRACE_WINDOW_SIZE - 1);
+		mWindowLength = std::min<uint64_t>(TRACE_WINDOW_SIZE, mFileSize - mWindowStart);
+		void* window = mmap(0, mWindowLength, PROT_READ, MAP_SHARED, mFd, mWindowStart);
+		if (window == MAP_FAILED) {
+			mLogger->report_failure("Unable to map trace window at offset " + std::to_string(mWindowStart) + ".");
+			exit(0);
+		}
+		madvise(window, mWindowLength, MADV_SEQUENTIAL);
+		mpWindow = (const uint8_t*)window;
+	}
+
+	uint64_t in_window = (mWindowStart + mWindowLength - position) / sizeof(TraceRecord);
+	count = std::min(in_window, mNumRecords - idx);
+	return (const TraceRecord*)(mpWindow + (position - mWindowStart));
+}
+
+void TraceReplay::ScanTrace(const std::string& file)
+{
+	uint64_t idx = 0;
+	while (idx < mNumRecords) {
+		uint64_t count;
+		const TraceRecord* records = this->MapRecords(idx, count);
+		for (uint64_t rec = 0; rec < count; rec++) {
+			const TraceRecord& record = records[rec];
+			bool valid_size = (record.size == 1 || record.size == 2 || record.size == 4 || record.size == 8);
+			if (record.op > TRACE_OP_NT_WRITE || !valid_size || record.size > mTargetSize ||
+				(record.op == TRACE_OP_NT_WRITE && record.size < 4)) {
+				mLogger->report_failure("Invalid record " + std::to_string(idx + rec) + " in trace " + file + ".");
+				exit(0);
+			}
+			if (record.op == TRACE_OP_READ || record.op == TRACE_OP_WRITE || record.op == TRACE_OP_NT_WRITE) {
+				mTraceBytes += record.size;
+			}
+		}
+		idx += count;
+	}
+}
+
+inline void TraceReplay::Replay(const TraceRecord& record)
+{
+	// Rebase like AddressList::RebaseAddressList(), offsets beyond the target wrap around
+	uint64_t addr = mTargetAddress + (record.offset % mTargetSize);
+	if (addr + record.size > mTargetAddress + mTargetSize) {
+		addr = mTargetAddress + mTargetSize - record.size;
+	}
+
+	switch (record.op) {
+	case TRACE_OP_READ:
+		primitive_read(addr, record.size);
+		break;
+	case TRACE_OP_WRITE:
+		primitive_write(addr, mPattern, record.size);
+		break;
+	case TRACE_OP_FLUSH:
+		primitive_flush(addr);
+		break;
+	case TRACE_OP_NT_WRITE:
+		primitive_write_nt(addr, mPattern, record.size);
+		break;
+	}
+}
+
+ret_t TraceReplay::run()
+{
+	uint64_t remaining = TRACE_RECORDS_PER_RUN;
+
+	while (remaining > 0) {
+		if (mNext == 0 || mNext >= mNumRecords) {
+			// Each pass over the trace restarts the recorded time line
+			mNext = 0;
+			mScheduleNs = 0;
+			mScheduleStart = std::chrono::steady_clock::now();
+		}
+
+		uint64_t count;
+		const TraceRecord* records = this->MapRecords(mNext, count);
+		count = std::min(count, remaining);
+
+		if (mTiming) {
+			for (uint64_t rec = 0; rec < count; rec++) {
+				// Deadlines are absolute so waiting time does not accumulate drift
+				mScheduleNs += records[rec].gap_ns;
+				while ((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+					   std::chrono::steady_clock::now() - mScheduleStart).count() < mScheduleNs) {
+					_mm_pause();
+				}
+				this->Replay(records[rec]);
+			}
+		} else {
+			for (uint64_t rec = 0; rec < count; rec++) {
+				this->Replay(records[rec]);
+			}
+		}
+
+		mNext += count;
+		remaining -= count;
+	}
+	return 0;
+}
+
+uint64_t TraceReplay::get_bytes_per_run()
+{
+	return (mTraceBytes * TRACE_RECORDS_PER_RUN) / mNumRecords;
+}
@@ -0,0 +1,125 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <string>
+#include <chrono>
+
+#include "IAlgorithm.h"
+
+#define TRACE_MAGIC              "CXLTRACE"
+#define TRACE_VERSION            1
+// Records replayed by a single run() call
+#define TRACE_RECORDS_PER_RUN    4096
+// Part of the trace file mapped at once, multiple of the page size
+#define TRACE_WINDOW_SIZE        0x4000000
+
+/**
+ * @brief Trace file header, followed by num_records TraceRecord entries.
+ */
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;
+	uint64_t num_records;
+	uint64_t reserved;
+} TraceHeader;
+
+/**
+ * @brief Single recorded access.
+ * offset is relative to the start of the traced region, gap_ns is the time since the previous record.
+ */
+typedef struct {
+	uint64_t offset;
+	uint32_t gap_ns;
+	uint8_t op;
+	uint8_t size;
+	uint16_t reserved;
+} TraceRecord;
+
+#define TRACE_OP_READ       0
+#define TRACE_OP_WRITE      1
+#define TRACE_OP_FLUSH      2
+#define TRACE_OP_NT_WRITE   3
+
+/**
+ * @class TraceReplay
+ * @brief Replays a binary address trace against the thread target.
+ * The trace is streamed through a sliding mmap window so traces bigger than memory are never
+ * materialized. Offsets are rebased onto the target address, wrapping at the target size.
+ * Thread switches: --trace=file, --trace-timing=1 to honour recorded gaps (default 0, full speed).
+ */
+class TraceReplay : public IAlgorithm
+{
+	private:
+		int mFd = -1;
+		uint64_t mNumRecords = 0;
+		uint64_t mTraceBytes = 0;
+		uint64_t mTargetAddress;
+		uint64_t mTargetSize;
+		bool mTiming = false;
+
+		const uint8_t* mpWindow = nullptr;
+		uint64_t mWindowStart = 0;
+		uint64_t mWindowLength = 0;
+		uint64_t mFileSize = 0;
+
+		uint64_t mNext = 0;
+		uint64_t mScheduleNs = 0;
+		std::chrono::steady_clock::time_point mScheduleStart;
+
+		/**
+		 * @brief Maps the window holding record idx.
+		 * @param count Set to the number of consecutive records available from idx.
+		 * @return Pointer to record idx.
+		 */
+		const TraceRecord* MapRecords(uint64_t idx, uint64_t& count);
+
+		/**
+		 * @brief Streams the whole trace once to validate records and count replayed bytes.
+		 */
+		void ScanTrace(const std::string& file);
+
+		/**
+		 * @brief Issues the access of a single record.
+		 */
+		inline void Replay(const TraceRecord& record);
+
+	public:
+		/**
+		 * @brief Opens and validates the trace given with --trace. Exits the test on error.
+		 *
+		 * @param config Thread parameters, uses pattern, target address and size and the trace switches.
+		 */
+		TraceReplay(const AlgoConfig& config);
+		~TraceReplay();
+
+		/**
+		 * @brief Replays the next TRACE_RECORDS_PER_RUN records, restarting at the end of the trace.
+		 */
+		ret_t run(void);
+
+		/**
+		 * @return uint64_t 0x0
+		 */
+		ret_t verify(void) { return 0x0; }
+
+		/**
+		 * @return 0x8, largest access a record can describe.
+		 */
+		uint64_t get_operation_size(void) { return 0x8; }
+
+		/**
+		 * @return Average bytes read and written by TRACE_RECORDS_PER_RUN records of this trace.
+		 */
+		uint64_t get_bytes_per_run(void);
+
+		/**
+		 * @return TRACE_RECORDS_PER_RUN
+		 */
+		uint64_t get_accesses_per_run(void) { return TRACE_RECORDS_PER_RUN; }
+};
@@ -0,0 +1,864 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <regex>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <atomic>
+
+#include <sched.h>
+#include <sys/mman.h>
+
+#include "utils/Logger.h"
+#include "algo/MulWrStream.h"
+#include "algo/PingPong.h"
+#include "algo/PointerChase.h"
+#include "AddressList.h"
+#include "generator/CpuTrafficGenerator.h"
+
+extern "C"
+{
+    #include <numa.h>
+}
+
+#define BENCH_LOGGER_ID          201
+// Lines per set used to lay out the working set, 32 KB per set
+#define BENCH_LINES_PER_SET      512
+// Minimum time a single repetition must run for the timer to be meaningful
+#define BENCH_MIN_REPEAT_NS      20000000ULL
+// Round trips measured for every core pair of the ping-pong matrix
+#define BENCH_PINGPONG_ROUNDS    20000
+// Working-set sweep latency rise over the current tier that starts a knee, and per step rise that extends it
+#define BENCH_KNEE_RATIO         1.25
+#define BENCH_KNEE_STEP          1.05
+// Working-set sweep default range, past LLC size into memory
+#define BENCH_WSS_MIN_SIZE       0x1000ULL
+#define BENCH_WSS_MIN_MEMORY     0x4000000ULL
+// Harness self-test: working set of the generator and length of each quiet or sampled window
+#define BENCH_HARNESS_SIZE       0x40000ULL
+#define BENCH_HARNESS_WINDOW_MS  200
+
+/**
+ * @brief Access kernel exercised by the benchmark.
+ * Prepare runs once before measuring, e.g. to fill the memory with the pattern a read kernel verifies.
+ */
+typedef struct {
+    std::string name;
+    std::function<std::shared_ptr<IAlgorithm>(void)> build;
+    std::function<std::shared_ptr<IAlgorithm>(void)> prepare;
+} BenchKernel;
+
+/**
+ * @brief Result of one kernel at one working-set size.
+ */
+typedef struct {
+    std::string kernel;
+    uint64_t size;
+    double median_ns;
+    double min_ns;
+    double stddev_ns;
+    double gbps;
+} BenchResult;
+
+/**
+ * @brief Ping-pong round trip latency between two cpus, relation is smt, socket or cross.
+ */
+typedef struct {
+    int cpu_a;
+    int cpu_b;
+    std::string relation;
+    double median_ns;
+    double p99_ns;
+} PingPongResult;
+
+/**
+ * @brief Data or unified cache level of the benchmark cpu, read from sysfs.
+ */
+typedef struct {
+    int level;
+    uint64_t size;
+} CacheLevel;
+
+/**
+ * @brief Working-set sweep point: chase latency and sequential read bandwidth at one size.
+ */
+typedef struct {
+    uint64_t size;
+    double latency_ns;
+    double gbps;
+} WssPoint;
+
+/**
+ * @brief Latency knee of a working-set curve, sizes from start to end are on the rise.
+ */
+typedef struct {
+    std::string label;
+    uint64_t start;
+    uint64_t end;
+    double before_ns;
+    double after_ns;
+} WssKnee;
+
+typedef struct {
+    int node = 0;
+    int cpu = -1;
+    uint64_t repeat = 10;
+    double threshold = 5.0;
+    std::vector<uint64_t> sizes;
+    std::string kernel_filter = ".*";
+    std::string output;
+    std::string baseline;
+    bool pingpong = false;
+    std::vector<int> cpus;
+    bool wss = false;
+    std::vector<int> wss_nodes;
+    bool harness = false;
+    uint64_t harness_window_ms = BENCH_HARNESS_WINDOW_MS;
+} BenchOptions;
+
+static const uint64_t bench_pattern = 0xcacabebe;
+
+/* Every algorithm kernel shipped with the tester, new kernels are added here. */
+static std::vector<BenchKernel> bench_kernels(void) {
+    auto mulwr = [](uint32_t params, uint8_t size) {
+        return [params, size]() { return std::static_pointer_cast<IAlgorithm>(std::make_shared<MulWrStreamNew>(params, bench_pattern, 0, size)); };
+    };
+    auto chase = []() {
+        AlgoConfig config = {0, 0, 0, 8, 0, 0, {}};
+        return std::static_pointer_cast<IAlgorithm>(std::make_shared<PointerChase>(config));
+    };
+    return {
+        {"mulwr-write-movb",        mulwr(0x0020, 1), nullptr},
+        {"mulwr-write-movw",        mulwr(0x0020, 2), nullptr},
+        {"mulwr-write-movl",        mulwr(0x0020, 4), nullptr},
+        {"mulwr-write-movq",        mulwr(0x0020, 8), nullptr},
+        {"mulwr-write-movnti",      mulwr(0x0010, 4), nullptr},
+        {"mulwr-read-movl",         mulwr(0x2000, 4), mulwr(0x0020, 4)},
+        {"mulwr-read-movq",         mulwr(0x2000, 8), mulwr(0x0020, 8)},
+        {"mulwr-flush",             mulwr(0x0001, 4), nullptr},
+        {"mulwr-write-read",        mulwr(0x2020, 4), nullptr},
+        {"mulwr-write-flush-read",  mulwr(0x2120, 4), nullptr},
+        {"mulwr-flush-write-flush-read", mulwr(0x2121, 4), nullptr},
+        {"chase",                   chase, nullptr},
+    };
+}
+
+static uint64_t parse_size(const std::string& value) {
+    std::smatch match;
+    if (!std::regex_match(value, match, std::regex("(0x[0-9a-fA-F]+|\\d+)([KMG]?)"))) {
+        throw std::invalid_argument("Invalid size " + value);
+    }
+    uint64_t size = std::stoull(match[1], nullptr, 0);
+    if (match[2] == "K") size <<= 10;
+    if (match[2] == "M") size <<= 20;
+    if (match[2] == "G") size <<= 30;
+    return size;
+}
+
+static void print_usage(void) {
+    std::cout << "| cxl_bench: runs every algorithm kernel on anonymous memory bound to a NUMA node." << std::endl;
+    std::cout << "| " << std::endl;
+    std::cout << "| \t--node=dec\t\tNUMA node backing the working set (default 0)." << std::endl;
+    std::cout << "| \t--cpu=dec\t\tCPU the kernels run on (default: current CPU)." << std::endl;
+    std::cout << "| \t--sizes=4K,64K,...\tWorking-set sizes (default 4K to 256M, doubling)." << std::endl;
+    std::cout << "| \t--repeat=dec\t\tRepetitions per point, median is reported (default 10)." << std::endl;
+    std::cout << "| \t--kernel=regex\t\tOnly run kernels matching regex." << std::endl;
+    std::cout << "| \t--out=file\t\tWrite JSON results to file instead of stdout (logs go to stderr when JSON takes stdout)." << std::endl;
+    std::cout << "| \t--baseline=file\t\tCompare against previous JSON results." << std::endl;
+    std::cout << "| \t--threshold=dec\t\tSlowdown percentage flagged as regression (default 5)." << std::endl;
+    std::cout << "| \t--pingpong\t\tMeasure cache line ping-pong latency between every pair of cpus instead." << std::endl;
+    std::cout << "| \t--cpus=dec,dec,...\tCpus of the ping-pong matrix (default: every cpu the benchmark may run on)." << std::endl;
+    std::cout << "| \t--wss[=dec,dec,...]\tGrow the working set from L1 size into memory on each node (default --node) with the chase and" << std::endl;
+    std::cout << "| \t\t\t\tread kernels, and annotate the cache level knees (default sizes: 4K to max(4 x LLC, 64M), two per doubling)." << std::endl;
+    std::cout << "| \t--harness[=ms]\t\tSelf-test: run a generator on the first of --cpus while the second polls its counters back to back in every" << std::endl;
+    std::cout << "| \t\t\t\tother window of ms (default 200), fails if the slowdown exceeds the noise of the quiet windows (default size 256K)." << std::endl;
+}
+
+static BenchOptions parse_options(int argc, char** argv) {
+    BenchOptions options;
+    std::smatch match;
+
+    for (int idx = 1; idx < argc; idx++) {
+        std::string option = argv[idx];
+        if (std::regex_match(option, match, std::regex("--node=(\\d+)"))) {
+            options.node = std::stoi(match[1]);
+        } else if (std::regex_match(option, match, std::regex("--cpu=(\\d+)"))) {
+            options.cpu = std::stoi(match[1]);
+        } else if (std::regex_match(option, match, std::regex("--repeat=(\\d+)"))) {
+            options.repeat = std::max(1ULL, std::stoull(match[1]));
+        } else if (std::regex_match(option, match, std::regex("--threshold=([0-9.]+)"))) {
+            options.threshold = std::stod(match[1]);
+        } else if (std::regex_match(option, match, std::regex("--kernel=(.+)"))) {
+            options.kernel_filter = match[1];
+        } else if (std::regex_match(option, match, std::regex("--out=(.+)"))) {
+            options.output = match[1];
+        } else if (std::regex_match(option, match, std::regex("--baseline=(.+)"))) {
+            options.baseline = match[1];
+        } else if (option == "--pingpong") {
+            options.pingpong = true;
+        } else if (std::regex_match(option, match, std::regex("--wss(=([0-9,]+))?"))) {
+            options.wss = true;
+            std::stringstream ss_nodes(match[2]);
+            for (std::string node; getline(ss_nodes, node, ',');) {
+                options.wss_nodes.push_back(std::stoi(node));
+            }
+        } else if (std::regex_match(option, match, std::regex("--harness(=(\\d+))?"))) {
+            options.harness = true;
+            if (match[2].matched) {
+                options.harness_window_ms = std::max(1ULL, std::stoull(match[2]));
+            }
+        } else if (std::regex_match(option, match, std::regex("--cpus=(.+)"))) {
+            std::stringstream ss_cpus(match[1]);
+            for (std::string cpu; getline(ss_cpus, cpu, ',');) {
+                options.cpus.push_back(std::stoi(cpu));
+            }
+        } else if (std::regex_match(option, match, std::regex("--sizes=(.+)"))) {
+            std::stringstream ss_sizes(match[1]);
+            for (std::string size; getline(ss_sizes, size, ',');) {
+                options.sizes.push_back(parse_size(size));
+            }
+        } else {
+            print_usage();
+            exit(option == "--help" || option == "-h" ? 0 : 1);
+        }
+    }
+
+    if (options.cpus.empty()) {
+        cpu_set_t allowed;
+        sched_getaffinity(0, sizeof(cpu_set_t), &allowed);
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) options.cpus.push_back(cpu);
+        }
+    }
+    if (options.wss && options.wss_nodes.empty()) {
+        options.wss_nodes.push_back(options.node);
+    }
+    // Working-set sweeps derive their sizes from the cache hierarchy
+    if (options.sizes.empty() && options.harness) {
+        options.sizes.push_back(BENCH_HARNESS_SIZE);
+    }
+    if (options.sizes.empty() && !options.wss) {
+        for (uint64_t size = 0x1000; size <= 0x10000000; size <<= 1) {
+            options.sizes.push_back(size);
+        }
+    }
+    return options;
+}
+
+/* Lays out size bytes as cache-line strided sets, the same geometry --define-target builds. */
+static std::shared_ptr<AddressList> build_address_list(uint64_t size, uint64_t base) {
+    uint64_t lines = std::max<uint64_t>(1, size / CACHELINE_SIZE);
+    uint16_t lines_per_set = std::min<uint64_t>(lines, BENCH_LINES_PER_SET);
+    // Prefer sets of equal length covering every line, e.g. 48K is 2 sets of 384 lines
+    for (uint64_t candidate = lines_per_set; candidate * 0xFFFF >= lines; candidate--) {
+        if (lines % candidate == 0) {
+            lines_per_set = candidate;
+            break;
+        }
+    }
+    if (lines / lines_per_set > 0xFFFF) {
+        Logger::build()->report_failure("Working set of " + std::to_string(size) + " bytes needs more than 65535 sets of " +
+                                        std::to_string(lines_per_set) + " lines, use a smaller size.");
+        exit(1);
+    }
+    uint16_t num_sets = std::max<uint64_t>(1, lines / lines_per_set);
+
+    auto addr_list = std::make_shared<AddressList>(0, num_sets, lines_per_set * CACHELINE_SIZE,
+                                                   lines_per_set, CACHELINE_SIZE);
+    addr_list->GenerateAddressList();
+    addr_list->RebaseAddressList(base);
+    return addr_list;
+}
+
+static BenchResult run_kernel(BenchKernel& kernel, uint64_t size, uint64_t base, uint64_t repeat) {
+    auto addr_list = build_address_list(size, base);
+
+    if (kernel.prepare) {
+        auto prepare = kernel.prepare();
+        prepare->setAddressList(addr_list);
+        prepare->run();
+    }
+
+    auto algo = kernel.build();
+    algo->setAddressList(addr_list);
+
+    // Warm up and calibrate iterations so each repetition runs long enough
+    uint64_t iterations = 1;
+    while (true) {
+        auto begin = std::chrono::steady_clock::now();
+        for (uint64_t iter = 0; iter < iterations; iter++) {
+            algo->run();
+        }
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+        if (elapsed >= BENCH_MIN_REPEAT_NS || iterations >= (1ULL << 30)) break;
+        iterations *= 2;
+    }
+
+    std::vector<double> samples;
+    for (uint64_t rep = 0; rep < repeat; rep++) {
+        auto begin = std::chrono::steady_clock::now();
+        for (uint64_t iter = 0; iter < iterations; iter++) {
+            if (algo->run() != 0) {
+                throw std::runtime_error("Kernel " + kernel.name + " failed self check.");
+            }
+        }
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+        samples.push_back((double)elapsed / (iterations * std::max<uint64_t>(1, algo->get_accesses_per_run())));
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double mean = 0, variance = 0;
+    for (auto & sample : samples) mean += sample;
+    mean /= samples.size();
+    for (auto & sample : samples) variance += (sample - mean) * (sample - mean);
+
+    BenchResult result;
+    result.kernel = kernel.name;
+    result.size = size;
+    result.median_ns = samples[samples.size() / 2];
+    result.min_ns = samples.front();
+    result.stddev_ns = std::sqrt(variance / samples.size());
+    // bytes per access averaged over the run, flush-only kernels report 0
+    double bytes_per_access = (double)algo->get_bytes_per_run() / std::max<uint64_t>(1, algo->get_accesses_per_run());
+    result.gbps = bytes_per_access / result.median_ns;
+    return result;
+}
+
+static std::string read_topology(int cpu, const std::string& name) {
+    std::ifstream input("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name);
+    std::string value;
+    getline(input, value);
+    return value;
+}
+
+/* SMT siblings share core and package, sockets are told apart by the package id. */
+static std::string cpu_relation(int cpu_a, int cpu_b) {
+    bool same_package = read_topology(cpu_a, "physical_package_id") == read_topology(cpu_b, "physical_package_id");
+    if (same_package && read_topology(cpu_a, "core_id") == read_topology(cpu_b, "core_id")) return "smt";
+    return same_package ? "socket" : "cross";
+}
+
+static void pin_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(cpu_set_t), &set) != 0) {
+        throw std::runtime_error("Unable to pin ping-pong thread to cpu " + std::to_string(cpu) + ".");
+    }
+}
+
+static PingPongResult run_pingpong(int cpu_a, int cpu_b, uint64_t line) {
+    memset((void*)line, 0, CACHELINE_SIZE);
+    auto addr_list = build_address_list(CACHELINE_SIZE, line);
+
+    AlgoConfig config = {0, 0, 0, 8, line, CACHELINE_SIZE, {{"hwid", "0"}, {"peer", "1"}}};
+    auto initiator = std::make_shared<PingPong>(config);
+    config.options = {{"hwid", "1"}, {"peer", "0"}};
+    auto responder = std::make_shared<PingPong>(config);
+    initiator->setAddressList(addr_list);
+    responder->setAddressList(addr_list);
+
+    std::atomic<bool> done(false);
+    std::thread answer([&]() {
+        pin_thread(cpu_b);
+        while (!done) responder->run();
+    });
+    std::thread send([&]() {
+        pin_thread(cpu_a);
+        while (initiator->get_rounds() < BENCH_PINGPONG_ROUNDS) initiator->run();
+        done = true;
+    });
+    send.join();
+    answer.join();
+
+    return {cpu_a, cpu_b, cpu_relation(cpu_a, cpu_b), initiator->get_percentile(50), initiator->get_percentile(99)};
+}
+
+static std::vector<PingPongResult> run_pingpong_matrix(std::shared_ptr<Logger> logger, const std::vector<int>& cpus, uint64_t line) {
+    std::vector<PingPongResult> results;
+    std::map<std::pair<int, int>, double> medians;
+    for (std::size_t idx = 0; idx < cpus.size(); idx++) {
+        for (std::size_t jdx = idx + 1; jdx < cpus.size(); jdx++) {
+            results.push_back(run_pingpong(cpus[idx], cpus[jdx], line));
+            medians[{cpus[idx], cpus[jdx]}] = medians[{cpus[jdx], cpus[idx]}] = results.back().median_ns;
+        }
+    }
+
+    // Median round trip in ns, each pair is measured once (lower index sends) and shown on both sides
+    std::stringstream ss;
+    ss << "| " << std::setw(6) << "cpu";
+    for (auto & cpu : cpus) ss << std::setw(8) << cpu;
+    logger->print(ss.str(), 2);
+    for (auto & cpu_a : cpus) {
+        ss.str(std::string());
+        ss << std::fixed << std::setprecision(0) << "| " << std::setw(6) << cpu_a;
+        for (auto & cpu_b : cpus) {
+            if (cpu_a == cpu_b) ss << std::setw(8) << "-";
+            else ss << std::setw(8) << medians[{cpu_a, cpu_b}];
+        }
+        logger->print(ss.str(), 2);
+    }
+
+    std::map<std::string, std::pair<double, uint64_t>> relations;
+    for (auto & result : results) {
+        relations[result.relation].first += result.median_ns;
+        relations[result.relation].second++;
+    }
+    for (auto & [relation, sum] : relations) {
+        ss.str(std::string());
+        ss << std::fixed << std::setprecision(1) << "| " << std::setw(8) << relation << ": " << sum.second
+           << " pair(s), mean median round trip " << sum.first / sum.second << " ns";
+        logger->print(ss.str(), 2);
+    }
+    return results;
+}
+
+static std::string pingpong_json(const BenchOptions& options, const std::vector<PingPongResult>& results) {
+    std::stringstream ss;
+    ss << "{\n  \"node\": " << options.node << ",\n  \"pingpong\": [\n";
+    for (std::size_t idx = 0; idx < results.size(); idx++) {
+        auto & result = results[idx];
+        ss << std::fixed << std::setprecision(4)
+           << "    {\"cpu_a\": " << result.cpu_a << ", \"cpu_b\": " << result.cpu_b << ", \"relation\": \""
+           << result.relation << "\", \"median_ns\": " << result.median_ns << ", \"p99_ns\": " << result.p99_ns << "}"
+           << ((idx + 1 < results.size()) ? "," : "") << "\n";
+    }
+    ss << "  ]\n}\n";
+    return ss.str();
+}
+
+/* Real stdout while std::cout is sent to stderr, so JSON printed without --out is the only thing on stdout. */
+static std::streambuf* json_stdout = nullptr;
+
+static void write_output(const BenchOptions& options, const std::string& json) {
+    if (options.output.empty()) {
+        std::ostream output(json_stdout ? json_stdout : std::cout.rdbuf());
+        output << json << std::flush;
+    } else {
+        std::ofstream output(options.output);
+        output << json;
+    }
+}
+
+/* Data and unified caches of cpu from sysfs, L1 first. */
+static std::vector<CacheLevel> read_caches(int cpu) {
+    std::vector<CacheLevel> caches;
+    for (int index = 0; ; index++) {
+        std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cache/index" + std::to_string(index) + "/";
+        std::ifstream level_file(path + "level"), type_file(path + "type"), size_file(path + "size");
+        if (!level_file.good()) break;
+        std::string level, type, size;
+        getline(level_file, level);
+        getline(type_file, type);
+        getline(size_file, size);
+        if (type == "Instruction" || size.empty()) continue;
+        caches.push_back({std::stoi(level), parse_size(size)});
+    }
+    std::sort(caches.begin(), caches.end(), [](const CacheLevel& a, const CacheLevel& b) { return a.level < b.level; });
+    return caches;
+}
+
+/* Two sizes per doubling from 4K until the working set is well past the last level cache. */
+static std::vector<uint64_t> wss_sizes(const std::vector<CacheLevel>& caches) {
+    uint64_t llc = caches.empty() ? 0 : caches.back().size;
+    uint64_t max_size = std::max<uint64_t>(4 * llc, BENCH_WSS_MIN_MEMORY);
+    std::vector<uint64_t> sizes;
+    for (uint64_t size = BENCH_WSS_MIN_SIZE; size <= max_size; size <<= 1) {
+        sizes.push_back(size);
+        if (size + size / 2 <= max_size) sizes.push_back(size + size / 2);
+    }
+    return sizes;
+}
+
+/* Knees are latency rises over the current tier. Each cache names the steepest knee starting within 4x of its size. */
+static std::vector<WssKnee> find_knees(const std::vector<WssPoint>& curve, const std::vector<CacheLevel>& caches) {
+    std::vector<WssKnee> knees;
+    std::size_t plateau = 0;
+    for (std::size_t idx = 1; idx < curve.size(); idx++) {
+        if (curve[idx].latency_ns < curve[plateau].latency_ns * BENCH_KNEE_RATIO) continue;
+        std::size_t end = idx;
+        while (end + 1 < curve.size() && curve[end + 1].latency_ns >= curve[end].latency_ns * BENCH_KNEE_STEP) end++;
+        knees.push_back({"unlabelled", curve[idx - 1].size, curve[end].size, curve[idx - 1].latency_ns, curve[end].latency_ns});
+        plateau = end;
+        idx = end;
+    }
+
+    for (std::size_t level = 0; level < caches.size(); level++) {
+        WssKnee* steepest = nullptr;
+        for (auto & knee : knees) {
+            if (knee.label != "unlabelled" || std::fabs(std::log2((double)knee.start / caches[level].size)) > 2) continue;
+            if (steepest == nullptr || knee.after_ns / knee.before_ns > steepest->after_ns / steepest->before_ns) steepest = &knee;
+        }
+        if (steepest != nullptr) {
+            steepest->label = "L" + std::to_string(caches[level].level) + "->" +
+                              ((level + 1 < caches.size()) ? "L" + std::to_string(caches[level + 1].level) : std::string("memory"));
+        }
+    }
+    return knees;
+}
+
+static std::string size_string(uint64_t size) {
+    if (size >= (1ULL << 30) && size % (1ULL << 30) == 0) return std::to_string(size >> 30) + "G";
+    if (size >= (1ULL << 20) && size % (1ULL << 20) == 0) return std::to_string(size >> 20) + "M";
+    if (size >= (1ULL << 10) && size % (1ULL << 10) == 0) return std::to_string(size >> 10) + "K";
+    return std::to_string(size);
+}
+
+static std::string wss_json(const std::vector<CacheLevel>& caches, const std::map<int, std::vector<WssPoint>>& curves,
+                            const std::map<int, std::vector<WssKnee>>& knees) {
+    std::stringstream ss;
+    ss << "{\n  \"caches\": [";
+    for (std::size_t idx = 0; idx < caches.size(); idx++) {
+        ss << ((idx > 0) ? ", " : "") << "{\"level\": " << caches[idx].level << ", \"size\": " << caches[idx].size << "}";
+    }
+    ss << "],\n  \"nodes\": [\n";
+    for (auto it = curves.begin(); it != curves.end(); ++it) {
+        ss << "    {\"node\": " << it->first << ", \"curve\": [\n";
+        for (std::size_t idx = 0; idx < it->second.size(); idx++) {
+            auto & point = it->second[idx];
+            ss << std::fixed << std::setprecision(4) << "      {\"size\": " << point.size << ", \"latency_ns\": " << point.latency_ns
+               << ", \"gbps\": " << point.gbps << "}" << ((idx + 1 < it->second.size()) ? "," : "") << "\n";
+        }
+        ss << "    ], \"knees\": [\n";
+        auto & node_knees = knees.at(it->first);
+        for (std::size_t idx = 0; idx < node_knees.size(); idx++) {
+            auto & knee = node_knees[idx];
+            ss << std::fixed << std::setprecision(4) << "      {\"label\": \"" << knee.label << "\", \"start\": " << knee.start
+               << ", \"end\": " << knee.end << ", \"before_ns\": " << knee.before_ns << ", \"after_ns\": " << knee.after_ns << "}"
+               << ((idx + 1 < node_knees.size()) ? "," : "") << "\n";
+        }
+        ss << "    ]}" << ((std::next(it) != curves.end()) ? "," : "") << "\n";
+    }
+    ss << "  ]\n}\n";
+    return ss.str();
+}
+
+/* Chase latency and read bandwidth at every working-set size, each node side by side. */
+static int run_wss(std::shared_ptr<Logger> logger, const BenchOptions& options) {
+    auto caches = read_caches(sched_getcpu());
+    auto sizes = options.sizes.empty() ? wss_sizes(caches) : options.sizes;
+    std::sort(sizes.begin(), sizes.end());
+    uint64_t max_size = sizes.back();
+
+    std::stringstream ss;
+    ss << "cxl_bench working-set sweep on cpu " << sched_getcpu() << ", caches:";
+    for (auto & cache : caches) ss << " L" << cache.level << " " << size_string(cache.size);
+    logger->print(ss.str(), BENCH_LOGGER_ID);
+
+    BenchKernel chase, read;
+    for (auto & kernel : bench_kernels()) {
+        if (kernel.name == "chase") chase = kernel;
+        if (kernel.name == "mulwr-read-movq") read = kernel;
+    }
+
+    std::map<int, std::vector<WssPoint>> curves;
+    std::map<int, std::vector<WssKnee>> knees;
+    for (auto & node : options.wss_nodes) {
+        if (node > numa_max_node()) {
+            logger->report_failure("NUMA node " + std::to_string(node) + " is not available.");
+            return -1;
+        }
+        void* region = numa_alloc_onnode(max_size, node);
+        if (region == nullptr) {
+            logger->report_failure("Unable to allocate " + std::to_string(max_size) + " bytes on node " + std::to_string(node) + ".");
+            return -1;
+        }
+        memset(region, 0, max_size);
+        mlock(region, max_size);
+
+        for (auto & size : sizes) {
+            double latency = run_kernel(chase, size, (uint64_t)region, options.repeat).median_ns;
+            // The read kernel loads one word of every line, the whole line moves
+            double gbps = CACHELINE_SIZE / run_kernel(read, size, (uint64_t)region, options.repeat).median_ns;
+            curves[node].push_back({size, latency, gbps});
+            ss.str(std::string());
+            ss << std::fixed << std::setprecision(2) << "| node " << std::setw(3) << node << std::setw(10) << size_string(size)
+               << std::setw(12) << latency << " ns/load" << std::setw(12) << gbps << " GB/s";
+            logger->print(ss.str(), 2);
+        }
+        numa_free(region, max_size);
+        knees[node] = find_knees(curves[node], caches);
+    }
+
+    // Curves side by side, knees marked where they start on the first node
+    ss.str(std::string());
+    ss << "| " << std::setw(10) << "size";
+    for (auto & node : options.wss_nodes) ss << std::setw(14) << ("node" + std::to_string(node) + " ns") << std::setw(14) << ("node" + std::to_string(node) + " GB/s");
+    logger->print(ss.str(), 2);
+    for (std::size_t idx = 0; idx < sizes.size(); idx++) {
+        ss.str(std::string());
+        ss << std::fixed << std::setprecision(2) << "| " << std::setw(10) << size_string(sizes[idx]);
+        for (auto & node : options.wss_nodes) ss << std::setw(14) << curves[node][idx].latency_ns << std::setw(14) << curves[node][idx].gbps;
+        for (auto & node : options.wss_nodes) {
+            for (auto & knee : knees[node]) {
+                if (knee.start == sizes[idx]) ss << "  <- node" << node << " " << knee.label;
+            }
+        }
+        logger->print(ss.str(), 2);
+    }
+    for (auto & node : options.wss_nodes) {
+        for (auto & knee : knees[node]) {
+            ss.str(std::string());
+            ss << std::fixed << std::setprecision(2) << "| node " << node << " " << knee.label << " knee " << size_string(knee.start)
+               << " to " << size_string(knee.end) << ": " << knee.before_ns << " -> " << knee.after_ns << " ns/load";
+            logger->print(ss.str(), 2);
+        }
+        ss.str(std::string());
+        ss << std::fixed << std::setprecision(2) << "| node " << node << " latency at " << size_string(sizes.back()) << ": "
+           << curves[node].back().latency_ns << " ns/load";
+        logger->print(ss.str(), 2);
+    }
+
+    write_output(options, wss_json(caches, curves, knees));
+    return 0;
+}
+
+static double median(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+/*
+ * Runs a CpuTrafficGenerator like the tester does and alternates quiet windows, where nobody reads its state,
+ * with sampled windows, where a control thread on another cpu snapshots it back to back.
+ * The loop rate must not drop by more than two standard deviations of the quiet windows.
+ */
+static int run_harness(std::shared_ptr<Logger> logger, const BenchOptions& options) {
+    if (options.cpus.size() < 2 || options.cpus[0] == options.cpus[1]) {
+        logger->report_failure("Harness self-test needs two distinct cpus, e.g. --cpus=worker,sampler.");
+        return -1;
+    }
+    int worker_cpu = options.cpus[0];
+    int sampler_cpu = options.cpus[1];
+    uint64_t size = options.sizes.front();
+
+    BenchKernel kernel;
+    for (auto & candidate : bench_kernels()) {
+        if (candidate.name == "mulwr-write-read") kernel = candidate;
+    }
+    void* region = numa_alloc_onnode(size, options.node);
+    if (region == nullptr) {
+        logger->report_failure("Unable to allocate " + std::to_string(size) + " bytes on node " + std::to_string(options.node) + ".");
+        return -1;
+    }
+    memset(region, 0, size);
+    mlock(region, size);
+
+    auto generator = std::make_shared<CpuTrafficGenerator>();
+    generator->setAffinity(worker_cpu);
+    generator->setAlgorithm(kernel.build());
+    generator->setAddressList(build_address_list(size, (uint64_t)region));
+    generator->configure();
+    std::thread worker([generator]() { generator->task(); });
+    pin_thread(sampler_cpu);
+    generator->start();
+    while (generator->getState() == TrafficGeneratorStateStart) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::stringstream ss;
+    ss << "cxl_bench harness self-test, " << kernel.name << " on " << size_string(size) << ", generator on cpu " << worker_cpu
+       << " (hot state on node " << generator->getHotNode() << "), sampler on cpu " << sampler_cpu << ".";
+    logger->print(ss.str(), BENCH_LOGGER_ID);
+
+    // First window warms caches and clocks up and is discarded
+    std::vector<double> quiet, sampled;
+    uint64_t polls = 0;
+    for (uint64_t window = 0; window < 2 * options.repeat + 1 && generator->getState() == TrafficGeneratorStateExecuting; window++) {
+        bool sampling = (window % 2) == 0 && window > 0;
+        auto begin = std::chrono::steady_clock::now();
+        auto end = begin + std::chrono::milliseconds(options.harness_window_ms);
+        uint64_t begin_loops = generator->snapshot().loops;
+        if (sampling) {
+            for (auto now = begin; now < end; now = std::chrono::steady_clock::now()) {
+                GeneratorSnapshot snapshot = generator->snapshot();
+                asm volatile("" : : "r"(snapshot.loops) : "memory");
+                polls++;
+            }
+        } else {
+            std::this_thread::sleep_until(end);
+        }
+        uint64_t loops = generator->snapshot().loops - begin_loops;
+        double seconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count() / 1e9;
+        if (window > 0) {
+            (sampling ? sampled : quiet).push_back(loops / seconds);
+        }
+    }
+    generator->stop();
+    worker.join();
+    numa_free(region, size);
+    if (generator->check() != 0 || quiet.empty() || sampled.empty()) {
+        logger->report_failure("Generator failed during the harness self-test.");
+        return -1;
+    }
+
+    double mean = 0, variance = 0;
+    for (auto & rate : quiet) mean += rate;
+    mean /= quiet.size();
+    for (auto & rate : quiet) variance += (rate - mean) * (rate - mean);
+    double noise = 2 * std::sqrt(variance / quiet.size()) / mean * 100.0;
+    double quiet_rate = median(quiet);
+    double sampled_rate = median(sampled);
+    double overhead = (quiet_rate - sampled_rate) / quiet_rate * 100.0;
+    double poll_rate = polls / (sampled.size() * options.harness_window_ms / 1e3);
+    bool passed = overhead <= noise;
+
+    ss.str(std::string());
+    ss << std::fixed << std::setprecision(2) << "| quiet " << quiet_rate << " loops/s, sampled " << sampled_rate << " loops/s at "
+       << poll_rate / 1e6 << " M snapshots/s";
+    logger->print(ss.str(), 2);
+    ss.str(std::string());
+    ss << std::fixed << std::setprecision(2) << "| harness overhead " << overhead << "%, noise floor " << noise << "%: " << (passed ? "PASS" : "FAIL");
+    logger->print(ss.str(), 2);
+
+    ss.str(std::string());
+    ss << std::fixed << std::setprecision(4) << "{\n  \"harness\": {\"kernel\": \"" << kernel.name << "\", \"size\": " << size
+       << ", \"worker_cpu\": " << worker_cpu << ", \"sampler_cpu\": " << sampler_cpu << ", \"hot_node\": " << generator->getHotNode()
+       << ", \"quiet_loops_per_s\": " << quiet_rate << ", \"sampled_loops_per_s\": " << sampled_rate << ", \"snapshots_per_s\": " << poll_rate
+       << ", \"overhead_pct\": " << overhead << ", \"noise_pct\": " << noise << ", \"passed\": " << (passed ? "true" : "false") << "}\n}\n";
+    write_output(options, ss.str());
+    if (!passed) {
+        logger->report_failure("Harness overhead is above the noise floor.");
+    }
+    return passed ? 0 : 1;
+}
+
+/* One result object per line so baselines can be read back without a JSON library. */
+static std::string to_json(const BenchOptions& options, const std::vector<BenchResult>& results) {
+    std::stringstream ss;
+    ss << "{\n  \"node\": " << options.node << ",\n  \"repeat\": " << options.repeat << ",\n  \"results\": [\n";
+    for (std::size_t idx = 0; idx < results.size(); idx++) {
+        auto & result = results[idx];
+        ss << std::fixed << std::setprecision(4)
+           << "    {\"kernel\": \"" << result.kernel << "\", \"size\": " << result.size
+           << ", \"median_ns\": " << result.median_ns << ", \"min_ns\": " << result.min_ns
+           << ", \"stddev_ns\": " << result.stddev_ns << ", \"gbps\": " << result.gbps << "}"
+           << ((idx + 1 < results.size()) ? "," : "") << "\n";
+    }
+    ss << "  ]\n}\n";
+    return ss.str();
+}
+
+static std::map<std::pair<std::string, uint64_t>, double> load_baseline(const std::string& file) {
+    std::map<std::pair<std::string, uint64_t>, double> baseline;
+    std::ifstream input(file);
+    std::smatch match;
+
+    if (!input.good()) {
+        throw std::runtime_error("Baseline file " + file + " not found.");
+    }
+    for (std::string line; getline(input, line);) {
+        if (std::regex_search(line, match, std::regex("\"kernel\": \"([^\"]+)\", \"size\": (\\d+), \"median_ns\": ([0-9.]+)"))) {
+            baseline[{match[1], std::stoull(match[2])}] = std::stod(match[3]);
+        }
+    }
+    return baseline;
+}
+
+int main(int argc, char** argv)
+{
+    std::shared_ptr<Logger> logger = Logger::build();
+    BenchOptions options = parse_options(argc, argv);
+    // Logs and tables go to stderr when the JSON results take stdout
+    if (options.output.empty()) {
+        json_stdout = std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    if (numa_available() < 0 || options.node > numa_max_node()) {
+        logger->report_failure("NUMA node " + std::to_string(options.node) + " is not available.");
+        return -1;
+    }
+
+    if (options.pingpong) {
+        // The shared line is homed on the benchmark node, dirty copies move between the cpus
+        void* line = numa_alloc_onnode(CACHELINE_SIZE, options.node);
+        if (line == nullptr) {
+            logger->report_failure("Unable to allocate a line on node " + std::to_string(options.node) + ".");
+            return -1;
+        }
+        logger->print("cxl_bench ping-pong matrix, line homed on node " + std::to_string(options.node) + ".", BENCH_LOGGER_ID);
+        auto results = run_pingpong_matrix(logger, options.cpus, (uint64_t)line);
+        numa_free(line, CACHELINE_SIZE);
+        write_output(options, pingpong_json(options, results));
+        return 0;
+    }
+
+    if (options.cpu >= 0) {
+        cpu_set_t cpu;
+        CPU_ZERO(&cpu);
+        CPU_SET(options.cpu, &cpu);
+        if (sched_setaffinity(0, sizeof(cpu_set_t), &cpu) != 0) {
+            logger->report_failure("Unable to pin benchmark to cpu " + std::to_string(options.cpu) + ".");
+            return -1;
+        }
+    }
+
+    if (options.wss) {
+        return run_wss(logger, options);
+    }
+
+    if (options.harness) {
+        return run_harness(logger, options);
+    }
+
+    uint64_t max_size = *std::max_element(options.sizes.begin(), options.sizes.end());
+    void* region = numa_alloc_onnode(max_size, options.node);
+    if (region == nullptr) {
+        logger->report_failure("Unable to allocate " + std::to_string(max_size) + " bytes on node " + std::to_string(options.node) + ".");
+        return -1;
+    }
+    memset(region, 0, max_size);
+    mlock(region, max_size);
+
+    logger->print("cxl_bench on node " + std::to_string(options.node) + ", cpu " + std::to_string(sched_getcpu()) + ".", BENCH_LOGGER_ID);
+
+    std::vector<BenchResult> results;
+    for (auto & kernel : bench_kernels()) {
+        if (!std::regex_match(kernel.name, std::regex(options.kernel_filter))) continue;
+        for (auto & size : options.sizes) {
+            results.push_back(run_kernel(kernel, size, (uint64_t)region, options.repeat));
+            std::stringstream ss;
+            ss << std::fixed << std::setprecision(2) << "| " << std::setw(32) << std::left << kernel.name
+               << std::right << std::setw(12) << size << std::setw(12) << results.back().median_ns << " ns/access"
+               << std::setw(12) << results.back().gbps << " GB/s";
+            logger->print(ss.str(), 2);
+        }
+    }
+
+    numa_free(region, max_size);
+
+    write_output(options, to_json(options, results));
+
+    if (options.baseline.empty()) {
+        return 0;
+    }
+
+    int regressions = 0;
+    auto baseline = load_baseline(options.baseline);
+    for (auto & result : results) {
+        auto entry = baseline.find({result.kernel, result.size});
+        if (entry == baseline.end() || entry->second <= 0) continue;
+        double slowdown = (result.median_ns - entry->second) / entry->second * 100.0;
+        if (slowdown > options.threshold) {
+            std::stringstream ss;
+            ss << std::fixed << std::setprecision(1) << "REGRESSION " << result.kernel << " size " << result.size
+               << ": " << entry->second << " -> " << result.median_ns << " ns/access (+" << slowdown << "%)";
+            logger->report_failure(ss.str());
+            regressions++;
+        }
+    }
+    logger->print(std::to_string(regressions) + " regression(s) beyond " + std::to_string((int)options.threshold) + "% against " + options.baseline + ".", BENCH_LOGGER_ID);
+    return (regressions == 0) ? 0 : 1;
+}
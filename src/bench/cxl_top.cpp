@@ -0,0 +1,195 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <map>
+#include <vector>
+#include <cerrno>
+
+#include <signal.h>
+
+#include "utils/Logger.h"
+#include "utils/LiveStats.h"
+
+#define TOP_DEFAULT_INTERVAL_MS    1000
+
+typedef struct {
+    std::string name = LIVE_STATS_DEFAULT_NAME;
+    std::uint64_t interval_ms = TOP_DEFAULT_INTERVAL_MS;
+    std::uint64_t count = 0;
+    bool batch = false;
+} TopOptions;
+
+/**
+ * @brief Rates of one generator between two refreshes.
+ */
+typedef struct {
+    LiveGeneratorSample sample;
+    double mbps;
+    double mops;
+    std::uint64_t p50_ns;
+    std::uint64_t p99_ns;
+} TopRow;
+
+// Indexed by TrafficGeneratorState
+static const char* state_names[] = {"reset", "start", "running", "stopped", "error"};
+
+static void print_usage(void) {
+    std::cout << "| cxl_top: live per-thread and per-node traffic of a CXLStressTester run started with --live." << std::endl;
+    std::cout << "| " << std::endl;
+    std::cout << "| \t--name=/name\t\tShared memory segment (default " << LIVE_STATS_DEFAULT_NAME << ")." << std::endl;
+    std::cout << "| \t--interval=dec\t\tRefresh period in ms (default " << TOP_DEFAULT_INTERVAL_MS << ")." << std::endl;
+    std::cout << "| \t--count=dec\t\tStop after count refreshes (default: until the test exits)." << std::endl;
+    std::cout << "| \t--batch\t\t\tAppend each refresh instead of redrawing the terminal." << std::endl;
+}
+
+static TopOptions parse_options(int argc, char** argv) {
+    TopOptions options;
+    std::smatch match;
+
+    for (int idx = 1; idx < argc; idx++) {
+        std::string option = argv[idx];
+        if (std::regex_match(option, match, std::regex("--name=(/[^/]+)"))) {
+            options.name = match[1];
+        } else if (std::regex_match(option, match, std::regex("--interval=(\\d+)"))) {
+            options.interval_ms = std::max(1ULL, std::stoull(match[1]));
+        } else if (std::regex_match(option, match, std::regex("--count=(\\d+)"))) {
+            options.count = std::stoull(match[1]);
+        } else if (option == "--batch") {
+            options.batch = true;
+        } else {
+            print_usage();
+            exit(option == "--help" || option == "-h" ? 0 : 1);
+        }
+    }
+    return options;
+}
+
+/* Upper bound of the bucket holding the given fraction of the iterations counted between two samples. */
+static std::uint64_t percentile_ns(const LiveGeneratorSample& now, const LiveGeneratorSample& before, double fraction) {
+    std::uint64_t total = 0;
+    for (int bucket = 0; bucket < LIVE_STATS_LATENCY_BUCKETS; bucket++) {
+        total += now.latency[bucket] - before.latency[bucket];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    std::uint64_t seen = 0;
+    for (int bucket = 0; bucket < LIVE_STATS_LATENCY_BUCKETS; bucket++) {
+        seen += now.latency[bucket] - before.latency[bucket];
+        if (seen >= fraction * total) {
+            return 1ULL << (bucket + LIVE_STATS_LATENCY_SHIFT + 1);
+        }
+    }
+    return 1ULL << (LIVE_STATS_LATENCY_BUCKETS + LIVE_STATS_LATENCY_SHIFT);
+}
+
+static std::string format_ns(std::uint64_t ns) {
+    if (ns == 0) return "-";
+    if (ns < 10000) return "<" + std::to_string(ns) + "ns";
+    if (ns < 10000000) return "<" + std::to_string(ns / 1000) + "us";
+    return "<" + std::to_string(ns / 1000000) + "ms";
+}
+
+static void print_rows(const std::vector<TopRow>& rows, const LiveStatsHeader* header, double seconds) {
+    std::stringstream ss;
+    ss << "cxl_top - pid " << header->pid << ", generation " << header->generation.load(std::memory_order_acquire)
+       << ", " << rows.size() << " threads, " << std::fixed << std::setprecision(2) << seconds << " s window\n\n";
+    ss << std::setw(8) << "hwid" << std::setw(8) << "type" << std::setw(6) << "node" << std::setw(10) << "state" << std::setw(8) << "active"
+       << std::setw(14) << "loops" << std::setw(12) << "MB/s" << std::setw(12) << "Mops/s" << std::setw(12) << "ns/access"
+       << std::setw(12) << "iter p50" << std::setw(12) << "iter p99" << std::setw(8) << "errors" << "\n";
+
+    std::map<std::uint64_t, std::pair<double, double>> nodes;
+    for (auto & row : rows) {
+        auto & sample = row.sample;
+        ss << std::setw(8) << sample.hw_id << std::setw(8) << ((sample.type == LiveGeneratorCore) ? "core" : "device") << std::setw(6) << sample.node
+           << std::setw(10) << ((sample.state < sizeof(state_names) / sizeof(state_names[0])) ? state_names[sample.state] : "?")
+           << std::setw(8) << (sample.active ? "yes" : "no") << std::setw(14) << sample.loops
+           << std::setw(12) << row.mbps << std::setw(12) << row.mops << std::setw(12) << ((row.mops > 0) ? 1e3 / row.mops : 0)
+           << std::setw(12) << format_ns(row.p50_ns) << std::setw(12) << format_ns(row.p99_ns) << std::setw(8) << sample.errors << "\n";
+        nodes[sample.node].first += row.mbps;
+        nodes[sample.node].second += row.mops;
+    }
+
+    ss << "\n" << std::setw(8) << "node" << std::setw(12) << "MB/s" << std::setw(12) << "Mops/s" << "\n";
+    for (auto & [node, rates] : nodes) {
+        ss << std::setw(8) << node << std::setw(12) << rates.first << std::setw(12) << rates.second << "\n";
+    }
+    std::cout << ss.str() << std::flush;
+}
+
+int main(int argc, char** argv)
+{
+    std::shared_ptr<Logger> logger = Logger::build();
+    TopOptions options = parse_options(argc, argv);
+
+    LiveStats live;
+    while (!live.open(options.name)) {
+        if (errno != ENOENT && errno != EAGAIN) {
+            logger->report_failure("Unable to map " + options.name + ", is it a live statistics segment of this version?");
+            return -1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(options.interval_ms));
+    }
+    const LiveStatsHeader* header = live.get_header();
+
+    std::map<std::uint64_t, LiveGeneratorSample> previous;
+    std::uint64_t generation = header->generation.load(std::memory_order_acquire);
+    auto last = std::chrono::steady_clock::now();
+    for (std::uint64_t refresh = 0; options.count == 0 || refresh <= options.count; refresh++) {
+        // Rates need two samples, the first refresh only records the baseline
+        if (refresh > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.interval_ms));
+        }
+        if (kill(header->pid, 0) != 0 && errno == ESRCH) {
+            std::cout << "Test " << header->pid << " exited." << std::endl;
+            return 0;
+        }
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count() / 1e9;
+        last = now;
+
+        // Slots were laid out again (sweep point), rates restart from the new counters
+        std::uint64_t current = header->generation.load(std::memory_order_acquire);
+        if (current != generation) {
+            previous.clear();
+            generation = current;
+        }
+
+        std::vector<TopRow> rows;
+        std::uint32_t used = header->used_slots.load(std::memory_order_relaxed);
+        for (std::uint32_t idx = 0; idx < used && idx < header->slot_count; idx++) {
+            TopRow row = {};
+            if (!live.read(idx, row.sample)) {
+                continue;
+            }
+            auto before = previous.find(row.sample.hw_id);
+            if (before != previous.end() && seconds > 0) {
+                row.mbps = (row.sample.bytes - before->second.bytes) / seconds / 1e6;
+                row.mops = (row.sample.accesses - before->second.accesses) / seconds / 1e6;
+                row.p50_ns = percentile_ns(row.sample, before->second, 0.50);
+                row.p99_ns = percentile_ns(row.sample, before->second, 0.99);
+            }
+            previous[row.sample.hw_id] = row.sample;
+            rows.push_back(row);
+        }
+        if (refresh == 0) {
+            continue;
+        }
+
+        if (!options.batch) {
+            std::cout << "\033[H\033[2J";
+        }
+        print_rows(rows, header, seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <sstream>
+
+#include "CxlAddressMap.h"
+#include "utils/Pagemap.h"
+
+CxlAddressMap::CxlAddressMap() {
+}
+
+std::shared_ptr<CxlAddressMap> CxlAddressMap::build() {
+    static std::shared_ptr<CxlAddressMap> object(new CxlAddressMap);
+    return object;
+}
+
+void CxlAddressMap::set_topology(const CxlTopology& topology) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->sets.clear();
+    auto & decoders = topology.get_decoders();
+    for (auto & [name, region] : topology.get_regions()) {
+        // Regions still being assembled cannot decode anything
+        if (region.size == 0 || region.interleave_granularity == 0 || region.targets.size() != region.interleave_ways) {
+            continue;
+        }
+        InterleaveSet set = {name, region.start, region.size, region.interleave_granularity, {}};
+        for (auto & target : region.targets) {
+            auto decoder = decoders.find(target);
+            if (decoder == decoders.end()) {
+                set.targets.push_back({target, "", 0});
+            } else {
+                set.targets.push_back({target, decoder->second.memdev, decoder->second.dpa_start});
+            }
+        }
+        this->sets[region.start] = set;
+    }
+}
+
+std::uint64_t CxlAddressMap::map_range(std::uint64_t vaddr, std::uint64_t size) {
+    Pagemap pagemap;
+    // Physical addresses are all hidden or all shown to a process, ask once with the first page
+    if (!this->probed && size != 0) {
+        this->visible = (pagemap.translate_range(vaddr, 1)[0] != 0);
+        this->probed = true;
+    }
+    MappedRange range = {size, {}};
+    if (this->visible) {
+        range.pages = pagemap.translate_range(vaddr, size);
+    }
+    std::uint64_t known = 0;
+    for (auto & page : range.pages) {
+        known += (page != 0);
+    }
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->ranges[vaddr] = std::move(range);
+    return known;
+}
+
+void CxlAddressMap::refresh(const std::vector<std::uint64_t>& pages, std::uint64_t page_size) {
+    if (!this->visible) {
+        return;
+    }
+    Pagemap pagemap;
+    std::vector<std::vector<std::uint64_t>> translations;
+    for (auto & page : pages) {
+        translations.push_back(pagemap.translate_range(page, page_size));
+    }
+
+    std::lock_guard<std::mutex> guard(this->lock);
+    for (std::size_t idx = 0; idx < pages.size(); idx++) {
+        auto range = this->ranges.upper_bound(pages[idx]);
+        if (range == this->ranges.begin()) {
+            continue;
+        }
+        range--;
+        std::uint64_t first = pages[idx] / PAGEMAP_PAGE_SIZE - range->first / PAGEMAP_PAGE_SIZE;
+        for (std::size_t entry = 0; entry < translations[idx].size() && first + entry < range->second.pages.size(); entry++) {
+            range->second.pages[first + entry] = translations[idx][entry];
+        }
+    }
+}
+
+void CxlAddressMap::clear(void) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->ranges.clear();
+}
+
+bool CxlAddressMap::decode(std::uint64_t vaddr, CxlAddressInfo& info) const {
+    info = {vaddr, 0, "", 0, "", "", 0};
+    std::lock_guard<std::mutex> guard(this->lock);
+    auto range = this->ranges.upper_bound(vaddr);
+    if (range == this->ranges.begin()) {
+        return false;
+    }
+    range--;
+    if (vaddr - range->first >= range->second.size) {
+        return false;
+    }
+    if (range->second.pages.empty()) {
+        return true;
+    }
+    std::uint64_t page = range->second.pages[vaddr / PAGEMAP_PAGE_SIZE - range->first / PAGEMAP_PAGE_SIZE];
+    if (page == 0) {
+        return true;
+    }
+    info.hpa = page + (vaddr & (PAGEMAP_PAGE_SIZE - 1));
+
+    auto set = this->sets.upper_bound(info.hpa);
+    if (set == this->sets.begin()) {
+        return true;
+    }
+    set--;
+    std::uint64_t offset = info.hpa - set->second.start;
+    if (offset >= set->second.size) {
+        return true;
+    }
+    // Granules go round robin over the positions, each device packs its granules back to back
+    std::uint64_t granularity = set->second.granularity;
+    std::uint64_t ways = set->second.targets.size();
+    auto & target = set->second.targets[(offset / granularity) % ways];
+    info.region = set->second.name;
+    info.position = (offset / granularity) % ways;
+    info.decoder = target.decoder;
+    info.memdev = target.memdev;
+    info.dpa = target.dpa_start + (offset / (granularity * ways)) * granularity + offset % granularity;
+    return true;
+}
+
+std::string CxlAddressMap::describe(std::uint64_t vaddr) const {
+    CxlAddressInfo info;
+    std::stringstream ss;
+    ss << "va 0x" << std::hex << vaddr;
+    if (!this->decode(vaddr, info)) {
+        ss << " (not in a mapped target)";
+    } else if (info.hpa == 0) {
+        ss << " hpa unknown (pagemap needs root)";
+    } else if (info.region.empty()) {
+        ss << " hpa 0x" << info.hpa << " (not in a CXL region)";
+    } else {
+        ss << " hpa 0x" << info.hpa << " " << info.region << " position " << std::dec << info.position << " " << info.decoder << " "
+           << (info.memdev.empty() ? "?" : info.memdev) << " dpa 0x" << std::hex << info.dpa;
+    }
+    return ss.str();
+}
+
+std::string CxlAddressMap::describe_lines(const std::uint64_t* lines, std::uint64_t count, std::uint64_t offset) const {
+    std::map<std::string, std::uint64_t> places;
+    for (std::uint64_t idx = 0; idx < count; idx++) {
+        CxlAddressInfo info;
+        if (!this->decode(lines[idx] + offset, info) || info.hpa == 0) {
+            places["hpa unknown"]++;
+        } else if (info.region.empty()) {
+            places["not in a CXL region"]++;
+        } else {
+            places[info.region + " position " + std::to_string(info.position) + " " + info.decoder + " " +
+                   (info.memdev.empty() ? "?" : info.memdev)]++;
+        }
+    }
+
+    std::stringstream ss;
+    ss << count << " lines";
+    const char* separator = ": ";
+    for (auto & [place, hits] : places) {
+        ss << separator << place << " (" << hits << " lines)";
+        separator = ", ";
+    }
+    return ss.str();
+}
@@ -0,0 +1,122 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "CxlTopology.h"
+
+/**
+ * @brief Where a virtual address of a target lands on the CXL side.
+ * hpa is 0 when pagemap hides physical addresses (not root) or the page is not present,
+ * region is empty when the host physical address is outside every CXL region.
+ */
+typedef struct {
+    std::uint64_t vaddr;
+    std::uint64_t hpa;
+    std::string region;
+    std::uint32_t position;
+    std::string decoder;
+    std::string memdev;
+    std::uint64_t dpa;
+} CxlAddressInfo;
+
+/**
+ * @class CxlAddressMap
+ * @brief Translates target virtual addresses to host physical addresses and decodes them to
+ * region, interleave position, endpoint decoder, memdev and device physical address.
+ * Page translations and the region interleave sets are captured at target setup, so decoding
+ * a miscompare is a table lookup and never reads pagemap or sysfs while generators run.
+ * Decoding follows the modulo interleave of the region targets, XOR host bridge interleave is not applied.
+ */
+class CxlAddressMap {
+   private:
+    /**
+     * @brief Endpoint of one interleave position.
+     */
+    typedef struct {
+        std::string decoder;
+        std::string memdev;
+        std::uint64_t dpa_start;
+    } InterleaveTarget;
+
+    typedef struct {
+        std::string name;
+        std::uint64_t start;
+        std::uint64_t size;
+        std::uint64_t granularity;
+        std::vector<InterleaveTarget> targets;
+    } InterleaveSet;
+
+    typedef struct {
+        std::uint64_t size;
+        /* Host physical address of every 4K page, 0 if unknown, empty when pagemap hides them all. */
+        std::vector<std::uint64_t> pages;
+    } MappedRange;
+
+    mutable std::mutex lock;
+    /* Interleave sets by region start. */
+    std::map<std::uint64_t, InterleaveSet> sets;
+    /* Target ranges by virtual start address. */
+    std::map<std::uint64_t, MappedRange> ranges;
+    /* Whether pagemap shows physical addresses to this process, probed on the first mapped range. */
+    bool probed = false;
+    bool visible = false;
+
+    CxlAddressMap();
+
+   public:
+    static std::shared_ptr<CxlAddressMap> build();
+
+    /**
+     * @brief Captures the interleave sets of the configured regions, replacing the previous ones.
+     */
+    void set_topology(const CxlTopology& topology);
+
+    /**
+     * @brief Translates every page of a target range, replacing any range starting at the same address.
+     * Pages must be present (touched) for pagemap to report them. No table is kept when pagemap
+     * hides physical addresses, which is checked once per process.
+     * @return Pages with a known host physical address.
+     */
+    std::uint64_t map_range(std::uint64_t vaddr, std::uint64_t size);
+
+    /**
+     * @brief Translates again pages of mapped ranges after they moved, e.g. by move_pages().
+     * @param pages Start address of each moved page.
+     * @param page_size Bytes per page.
+     */
+    void refresh(const std::vector<std::uint64_t>& pages, std::uint64_t page_size);
+
+    /**
+     * @brief Forgets every target range, interleave sets are kept.
+     */
+    void clear(void);
+
+    /**
+     * @brief Decodes vaddr from the captured tables.
+     * @return false if vaddr is outside every mapped range.
+     */
+    bool decode(std::uint64_t vaddr, CxlAddressInfo& info) const;
+
+    /**
+     * @return Single line decode of vaddr for failure reports, e.g.
+     * "va 0x... hpa 0x... region0 position 1 decoder3.0 mem1 dpa 0x...".
+     */
+    std::string describe(std::uint64_t vaddr) const;
+
+    /**
+     * @return Regions, positions and memdevs the bytes at offset of count lines decode to, used when a
+     * miscompare is only known to be on one of them, e.g. "64 lines: region0 position 0 decoder2.0 mem0 (32 lines), ...".
+     */
+    std::string describe_lines(const std::uint64_t* lines, std::uint64_t count, std::uint64_t offset) const;
+};
@@ -0,0 +1,266 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <regex>
+#include <algorithm>
+#include <filesystem>
+
+#include "CxlTopology.h"
+
+#define TOPOLOGY_LOGGER_ID    64
+#define CXL_BUS_DEVICES       "bus/cxl/devices"
+#define NODE_DEVICES          "devices/system/node"
+#define MEMORY_BLOCK_SIZE     "devices/system/memory/block_size_bytes"
+
+namespace fs = std::filesystem;
+
+/* First line of a sysfs attribute, empty if it cannot be read. */
+static std::string read_attribute(const std::string& file) {
+    std::ifstream input(file);
+    std::string value;
+    getline(input, value);
+    return value;
+}
+
+/* Sysfs numbers are decimal, or hex with a 0x prefix. base forces hex for attributes printed without it. */
+static std::uint64_t read_number(const std::string& file, int base = 0) {
+    std::string value = read_attribute(file);
+    try {
+        return value.empty() ? 0 : std::stoull(value, nullptr, base);
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+/* Signed attribute such as a NUMA node, fallback when absent or not a number. */
+static int read_integer(const std::string& file, int fallback = -1) {
+    std::string value = read_attribute(file);
+    try {
+        return value.empty() ? fallback : std::stoi(value);
+    } catch (const std::exception&) {
+        return fallback;
+    }
+}
+
+/* Entries of dir whose name matches pattern, sorted so numbered devices come in a stable order. */
+static std::vector<std::string> list_entries(const std::string& dir, const std::string& pattern) {
+    std::vector<std::string> names;
+    std::error_code error;
+    for (auto & entry : fs::directory_iterator(dir, error)) {
+        std::string name = entry.path().filename().string();
+        if (std::regex_match(name, std::regex(pattern))) {
+            names.push_back(name);
+        }
+    }
+    std::sort(names.begin(), names.end(), [](const std::string& a, const std::string& b) {
+        return (a.size() != b.size()) ? a.size() < b.size() : a < b;
+    });
+    return names;
+}
+
+static std::string size_string(std::uint64_t size) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    if (size >= (1ULL << 30)) ss << (double)size / (1ULL << 30) << " GiB";
+    else ss << (double)size / (1ULL << 20) << " MiB";
+    return ss.str();
+}
+
+CxlTopology::CxlTopology(const std::string& root) {
+    this->logger = Logger::build();
+    this->root = root;
+}
+
+std::string CxlTopology::path(const std::string& relative) const {
+    return this->root + "/" + relative;
+}
+
+void CxlTopology::discover(void) {
+    this->memdevs.clear();
+    this->decoders.clear();
+    this->regions.clear();
+    this->nodes.clear();
+    this->discover_memdevs();
+    this->discover_decoders();
+    this->discover_nodes();
+    this->discover_regions();
+}
+
+void CxlTopology::discover_memdevs(void) {
+    for (auto & name : list_entries(this->path(CXL_BUS_DEVICES), "mem\\d+")) {
+        std::string dir = this->path(CXL_BUS_DEVICES "/" + name + "/");
+        CxlMemdev memdev = {name, read_attribute(dir + "serial"), read_number(dir + "ram/size"), read_number(dir + "pmem/size"),
+                            read_integer(dir + "numa_node")};
+        this->memdevs[name] = memdev;
+    }
+}
+
+void CxlTopology::discover_decoders(void) {
+    std::smatch match;
+    for (auto & name : list_entries(this->path(CXL_BUS_DEVICES), "decoder\\d+\\.\\d+")) {
+        std::string dir = this->path(CXL_BUS_DEVICES "/" + name + "/");
+        CxlDecoder decoder = {};
+        decoder.name = name;
+        decoder.start = read_number(dir + "start");
+        decoder.size = read_number(dir + "size");
+        decoder.interleave_ways = read_number(dir + "interleave_ways");
+        decoder.interleave_granularity = read_number(dir + "interleave_granularity");
+        decoder.region = read_attribute(dir + "region");
+        decoder.mode = read_attribute(dir + "mode");
+        decoder.dpa_start = read_number(dir + "dpa_resource");
+        decoder.dpa_size = read_number(dir + "dpa_size");
+
+        // decoderP.N belongs to the port of id P: rootP, portP or endpointP
+        std::regex_match(name, match, std::regex("decoder(\\d+)\\.\\d+"));
+        std::string port = match[1];
+        std::error_code error;
+        if (fs::exists(this->path(CXL_BUS_DEVICES "/endpoint" + port), error)) {
+            decoder.kind = "endpoint";
+            // The endpoint port links to the memdev it was enumerated from
+            fs::path uport = fs::read_symlink(this->path(CXL_BUS_DEVICES "/endpoint" + port + "/uport"), error);
+            decoder.memdev = error ? "" : uport.filename().string();
+        } else if (fs::exists(this->path(CXL_BUS_DEVICES "/root" + port), error)) {
+            decoder.kind = "root";
+        } else {
+            decoder.kind = "switch";
+        }
+        this->decoders[name] = decoder;
+    }
+}
+
+void CxlTopology::discover_nodes(void) {
+    for (auto & name : list_entries(this->path(NODE_DEVICES), "node\\d+")) {
+        std::string dir = this->path(NODE_DEVICES "/" + name + "/");
+        NumaNodeInfo node = {std::stoi(name.substr(4)), false, 0, {}};
+        std::string cpus = read_attribute(dir + "cpulist");
+        node.has_cpus = cpus.find_first_of("0123456789") != std::string::npos;
+        std::ifstream meminfo(dir + "meminfo");
+        std::smatch match;
+        for (std::string line; getline(meminfo, line);) {
+            if (std::regex_search(line, match, std::regex("MemTotal:\\s+(\\d+) kB"))) {
+                node.mem_total = std::stoull(match[1]) << 10;
+            }
+        }
+        this->nodes[node.id] = node;
+    }
+}
+
+int CxlTopology::region_node(const CxlRegion& region, const std::map<std::uint64_t, int>& blocks, std::uint64_t block_size) {
+    // Memory blocks of the region range are owned by the node that onlined them
+    std::map<int, std::uint64_t> owned;
+    if (block_size != 0) {
+        for (auto it = blocks.lower_bound(region.start / block_size); it != blocks.end() && it->first * block_size < region.start + region.size; it++) {
+            owned[it->second]++;
+        }
+    }
+    if (!owned.empty()) {
+        return std::max_element(owned.begin(), owned.end(), [](const auto& a, const auto& b) { return a.second < b.second; })->first;
+    }
+    // Not onlined (yet), the dax device still tells which node it would join
+    std::string dir = this->path(CXL_BUS_DEVICES "/" + region.name + "/");
+    for (auto & dax_region : list_entries(dir, "dax_region\\d+")) {
+        for (auto & dax : list_entries(dir + dax_region, "dax\\d+\\.\\d+")) {
+            int node = read_integer(dir + dax_region + "/" + dax + "/target_node");
+            if (node >= 0) {
+                return node;
+            }
+        }
+    }
+    return -1;
+}
+
+void CxlTopology::discover_regions(void) {
+    // Memory block number to owning node, from the memoryN links of every node
+    std::map<std::uint64_t, int> blocks;
+    std::uint64_t block_size = read_number(this->path(MEMORY_BLOCK_SIZE), 16);
+    for (auto & [id, node] : this->nodes) {
+        for (auto & block : list_entries(this->path(NODE_DEVICES "/node" + std::to_string(id)), "memory\\d+")) {
+            blocks[std::stoull(block.substr(6))] = id;
+        }
+    }
+
+    for (auto & name : list_entries(this->path(CXL_BUS_DEVICES), "region\\d+")) {
+        std::string dir = this->path(CXL_BUS_DEVICES "/" + name + "/");
+        CxlRegion region = {};
+        region.name = name;
+        region.mode = read_attribute(dir + "mode");
+        region.start = read_number(dir + "resource");
+        region.size = read_number(dir + "size");
+        region.interleave_ways = read_number(dir + "interleave_ways");
+        region.interleave_granularity = read_number(dir + "interleave_granularity");
+        for (std::uint32_t position = 0; position < region.interleave_ways; position++) {
+            std::string target = read_attribute(dir + "target" + std::to_string(position));
+            if (!target.empty()) {
+                region.targets.push_back(target);
+            }
+        }
+        // Unconfigured regions have no range yet
+        region.node = (region.size != 0) ? this->region_node(region, blocks, block_size) : -1;
+        if (this->nodes.count(region.node)) {
+            this->nodes[region.node].regions.push_back(name);
+        }
+        this->regions[name] = region;
+    }
+}
+
+std::vector<int> CxlTopology::get_cxl_nodes(void) const {
+    std::vector<int> cxl_nodes;
+    for (auto & [id, node] : this->nodes) {
+        if (!node.regions.empty()) {
+            cxl_nodes.push_back(id);
+        }
+    }
+    return cxl_nodes;
+}
+
+const CxlRegion* CxlTopology::find_region(std::uint64_t hpa) const {
+    for (auto & [name, region] : this->regions) {
+        if (hpa >= region.start && hpa - region.start < region.size) {
+            return &region;
+        }
+    }
+    return nullptr;
+}
+
+void CxlTopology::print(void) const {
+    this->logger->print("CXL topology from " + this->root + ": " + std::to_string(this->memdevs.size()) + " memdev(s), " +
+                        std::to_string(this->regions.size()) + " region(s), " + std::to_string(this->decoders.size()) + " decoder(s).", TOPOLOGY_LOGGER_ID);
+
+    std::stringstream ss;
+    ss << "| " << std::setw(6) << "node" << std::setw(8) << "cpus" << std::setw(14) << "memory" << "  regions";
+    this->logger->print(ss.str(), 2);
+    for (auto & [id, node] : this->nodes) {
+        ss.str(std::string());
+        ss << "| " << std::setw(6) << id << std::setw(8) << (node.has_cpus ? "yes" : "no") << std::setw(14) << size_string(node.mem_total) << " ";
+        for (auto & region : node.regions) ss << " " << region;
+        if (node.regions.empty() && !node.has_cpus) ss << " (memory only, no CXL region)";
+        this->logger->print(ss.str(), 2);
+    }
+
+    for (auto & [name, region] : this->regions) {
+        ss.str(std::string());
+        ss << "| " << name << " " << (region.mode.empty() ? "?" : region.mode) << " hpa 0x" << std::hex << region.start << "-0x"
+           << (region.start + region.size) << std::dec << " (" << size_string(region.size) << "), " << region.interleave_ways << " way(s) x "
+           << region.interleave_granularity << " B, node " << ((region.node >= 0) ? std::to_string(region.node) : "none") << ":";
+        for (auto & target : region.targets) {
+            auto decoder = this->decoders.find(target);
+            ss << " " << target;
+            if (decoder != this->decoders.end() && !decoder->second.memdev.empty()) ss << "(" << decoder->second.memdev << ")";
+        }
+        this->logger->print(ss.str(), 2);
+    }
+
+    for (auto & [name, memdev] : this->memdevs) {
+        ss.str(std::string());
+        ss << "| " << name << " serial " << (memdev.serial.empty() ? "?" : memdev.serial) << ", ram " << size_string(memdev.ram_size)
+           << ", pmem " << size_string(memdev.pmem_size) << ", near node " << memdev.numa_node;
+        this->logger->print(ss.str(), 2);
+    }
+}
@@ -0,0 +1,127 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "utils/Logger.h"
+
+#define CXL_SYSFS_DEFAULT_ROOT    "/sys"
+
+/**
+ * @brief CXL memory device (memN), sizes of its volatile and persistent partitions.
+ */
+typedef struct {
+    std::string name;
+    std::string serial;
+    std::uint64_t ram_size;
+    std::uint64_t pmem_size;
+    /* Node closest to the device (host bridge proximity), not the node onlining its memory. -1 if unknown. */
+    int numa_node;
+} CxlMemdev;
+
+/**
+ * @brief HDM decoder (decoderP.N of port P). kind is root, switch or endpoint.
+ * Endpoint decoders also know their memdev and the device physical address range they decode.
+ */
+typedef struct {
+    std::string name;
+    std::string kind;
+    std::uint64_t start;
+    std::uint64_t size;
+    std::uint32_t interleave_ways;
+    std::uint64_t interleave_granularity;
+    std::string region;
+    std::string mode;
+    std::string memdev;
+    std::uint64_t dpa_start;
+    std::uint64_t dpa_size;
+} CxlDecoder;
+
+/**
+ * @brief Host physical address range backed by the endpoint decoders in targets, in interleave position order.
+ */
+typedef struct {
+    std::string name;
+    std::string mode;
+    std::uint64_t start;
+    std::uint64_t size;
+    std::uint32_t interleave_ways;
+    std::uint64_t interleave_granularity;
+    std::vector<std::string> targets;
+    /* NUMA node the region is onlined on as system RAM, -1 if it is not. */
+    int node;
+} CxlRegion;
+
+/**
+ * @brief NUMA node as seen in sysfs, CXL nodes are the ones onlining at least one region.
+ */
+typedef struct {
+    int id;
+    bool has_cpus;
+    std::uint64_t mem_total;
+    std::vector<std::string> regions;
+} NumaNodeInfo;
+
+/**
+ * @class CxlTopology
+ * @brief Walks the CXL bus (memdevs, decoders, regions) and the NUMA nodes in sysfs and maps regions
+ * to the nodes onlining them, by memory block ownership or by the dax device target node.
+ * The sysfs root is a parameter so discovery can run against a captured copy of another machine.
+ */
+class CxlTopology {
+   private:
+    std::string root;
+    std::shared_ptr<Logger> logger;
+    std::map<std::string, CxlMemdev> memdevs;
+    std::map<std::string, CxlDecoder> decoders;
+    std::map<std::string, CxlRegion> regions;
+    std::map<int, NumaNodeInfo> nodes;
+
+    std::string path(const std::string& relative) const;
+    void discover_memdevs(void);
+    void discover_decoders(void);
+    void discover_regions(void);
+    void discover_nodes(void);
+    int region_node(const CxlRegion& region, const std::map<std::uint64_t, int>& blocks, std::uint64_t block_size);
+
+   public:
+    /**
+     * @param root Directory holding bus/cxl and devices/system, /sys on a live machine.
+     */
+    CxlTopology(const std::string& root = CXL_SYSFS_DEFAULT_ROOT);
+
+    /**
+     * @brief Reads everything again. A machine without CXL bus just has no memdevs, decoders or regions.
+     */
+    void discover(void);
+
+    /**
+     * @return NUMA nodes onlining at least one CXL region, in ascending order.
+     */
+    std::vector<int> get_cxl_nodes(void) const;
+
+    /**
+     * @return Region whose host physical address range holds hpa, nullptr if none does.
+     */
+    const CxlRegion* find_region(std::uint64_t hpa) const;
+
+    const std::map<std::string, CxlMemdev>& get_memdevs(void) const { return this->memdevs; }
+    const std::map<std::string, CxlDecoder>& get_decoders(void) const { return this->decoders; }
+    const std::map<std::string, CxlRegion>& get_regions(void) const { return this->regions; }
+    const std::map<int, NumaNodeInfo>& get_nodes(void) const { return this->nodes; }
+    const std::string& get_root(void) const { return this->root; }
+
+    /**
+     * @brief Prints nodes, regions with their interleave set and memdevs.
+     */
+    void print(void) const;
+};
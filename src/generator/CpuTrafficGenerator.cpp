@@ -9,35 +9,41 @@
 #include <thread>
 #include <chrono>
 #include <sched.h>
+#include <sstream>
+#include <iomanip>
 #include "CpuTrafficGenerator.h"
+
+extern "C"
+{
+	#include <numa.h>
+}
 #define CPU_GENERATOR_LOGGER_ID       54
 
 CpuTrafficGenerator::CpuTrafficGenerator()
 {
-	mLoops = 0;
 }
 
 CpuTrafficGenerator::CpuTrafficGenerator(std::shared_ptr<AddressList> addrList)
 {
-	mLoops = 0;
 	mpAddrList = std::move(addrList);
 }
 
 ret_t CpuTrafficGenerator::configure()
 {
+	mpHot->control.active = true;
 	return 0;
 }
 
 ret_t CpuTrafficGenerator::start()
 {
-	mState = TrafficGeneratorStateStart;
+	mpHot->control.state = TrafficGeneratorStateStart;
 	mLogger->print("Start.", CPU_GENERATOR_LOGGER_ID);
 	return 0;
 }
 
 ret_t CpuTrafficGenerator::stop()
 {
-	mState = TrafficGeneratorStateStop;
+	mpHot->control.state = TrafficGeneratorStateStop;
 	mLogger->print("Stopping.", CPU_GENERATOR_LOGGER_ID);
 	return 0;
 }
@@ -49,7 +55,47 @@ ret_t CpuTrafficGenerator::check()
 
 void CpuTrafficGenerator::print()
 {
-	mLogger->print("cpu id: " + std::to_string(mApicId) + ", loops: " + std::to_string(mLoops), CPU_GENERATOR_LOGGER_ID);
+	mLogger->print("cpu id: " + std::to_string(mApicId) + ", loops: " + std::to_string(getLoops()), CPU_GENERATOR_LOGGER_ID);
+
+	std::string report = mpAlgo->get_report();
+	if (!report.empty()) {
+		mLogger->print("cpu id: " + std::to_string(mApicId) + ", " + report, CPU_GENERATOR_LOGGER_ID);
+	}
+
+	if (!mpPerf) {
+		return;
+	}
+
+	std::stringstream ss;
+	ss << "cpu id: " << mApicId << ", perf" << (mpPerf->is_software() ? " (software events)" : "") << ":";
+	for (auto & event : mpPerf->get_events()) {
+		ss << " " << event.name << "=" << event.value;
+	}
+	mLogger->print(ss.str(), CPU_GENERATOR_LOGGER_ID);
+	ss.str(std::string());
+
+	double accesses = (double)getLoops() * getAccessesPerLoop();
+	if (accesses == 0) {
+		return;
+	}
+
+	ss << std::fixed << std::setprecision(3) << "cpu id: " << mApicId;
+	if (mpPerf->is_software()) {
+		ss << ", task-clock ns/access: " << mpPerf->value("task-clock") / accesses;
+		mLogger->print(ss.str(), CPU_GENERATOR_LOGGER_ID);
+		return;
+	}
+	if (mpPerf->value("cycles") != 0) {
+		ss << ", IPC: " << (double)mpPerf->value("instructions") / mpPerf->value("cycles");
+	}
+	ss << ", cycles/access: " << mpPerf->value("cycles") / accesses;
+	if (mpPerf->has("llc-misses")) {
+		ss << ", LLC misses/access: " << mpPerf->value("llc-misses") / accesses;
+	}
+	if (mpPerf->has("dtlb-misses")) {
+		ss << ", dTLB misses/access: " << mpPerf->value("dtlb-misses") / accesses;
+	}
+	mLogger->print(ss.str(), CPU_GENERATOR_LOGGER_ID);
 }
 
 void CpuTrafficGenerator::dump()
@@ -57,6 +103,17 @@ void CpuTrafficGenerator::dump()
 	return;
 }
 
+uint64_t CpuTrafficGenerator::getBytesPerLoop()
+{
+	// The algorithm may be replaced between iterations while other threads sample
+	return std::atomic_load(&mpAlgo)->get_bytes_per_run();
+}
+
+uint64_t CpuTrafficGenerator::getAccessesPerLoop()
+{
+	return std::atomic_load(&mpAlgo)->get_accesses_per_run();
+}
+
 ret_t CpuTrafficGenerator::task()
 {
 	cpu_set_t cpu;
@@ -76,43 +133,118 @@ ret_t CpuTrafficGenerator::task()
 	do {
 		// mLogger->print("Thread " + std::to_string(sched_getcpu()) + " waiting to start.", CPU_GENERATOR_LOGGER_ID);
 		std::this_thread::sleep_for(std::chrono::seconds(1));
-	} while (mState == TrafficGeneratorStateReset);
+	} while (mpHot->control.state == TrafficGeneratorStateReset);
 
 	mLogger->print("Thread " + std::to_string(sched_getcpu()) + " running.", CPU_GENERATOR_LOGGER_ID);
 	do {
-	} while (mState != TrafficGeneratorStateStart);
+	} while (mpHot->control.state != TrafficGeneratorStateStart);
 
 
-	if (mState == TrafficGeneratorStateStart) {
-		mState = TrafficGeneratorStateExecuting;
+	if (mPerfEnabled) {
+		mpPerf = std::make_shared<PerfCounters>();
+		if (!mpPerf->open(mPerfRawEvents)) {
+			mpPerf.reset();
+		}
+	}
+
+	if (mpHot->control.state == TrafficGeneratorStateStart) {
+		mpHot->control.state = TrafficGeneratorStateExecuting;
 	} else {
 		mLogger->report_failure("State machine error found. CPUID=" + std::to_string(sched_getcpu()));
 		//return -1;
 		return 0;
 	}
 
+	// Measurement window is the execution loop only
+	if (mpPerf) {
+		mpPerf->enable();
+	}
+
+	// Hot words are read through local references, the loop count stays in a register between iterations
+	GeneratorControl& control = mpHot->control;
+	std::atomic<uint64_t>& loopsCounter = mpHot->counters.loops;
+	uint64_t loops = loopsCounter.load(std::memory_order_relaxed);
+
+	// Pacing restarts whenever the rate changes or the generator resumes
+	uint64_t paceRate = 0, paceBytes = 0;
+	auto paceBegin = std::chrono::steady_clock::now();
+	bool liveIdle = false;
 	do {
+		// Idle while the phase scheduler keeps this generator out of the current phase, or while it is held
+		uint32_t holds = control.holds.load();
+		if (!control.active.load(std::memory_order_relaxed) || holds != 0) {
+			if (holds != 0) {
+				control.held_epoch.store(control.hold_epoch.load());
+			}
+			paceRate = 0;
+			if (mpLiveSlot && !liveIdle) {
+				publishLive(0, 0, 0);
+				liveIdle = true;
+			}
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+			continue;
+		}
+		liveIdle = false;
+		if (control.pending.load(std::memory_order_acquire)) {
+			applyPending();
+			paceRate = 0;
+		}
+		uint64_t rate = control.rate.load(std::memory_order_relaxed);
+		if (paceRate != rate) {
+			paceRate = rate;
+			paceBytes = 0;
+			paceBegin = std::chrono::steady_clock::now();
+		}
+
+		bool sampled = mpTimeline && mpTimeline->begin_iteration();
+		uint64_t begin = (sampled || mpLiveSlot) ? Timeline::now() : 0;
 		int ret = mpAlgo->run();
+		if (sampled && mpTimeline->is_sampled()) {
+			mpTimeline->record(TimelineSpanIteration, begin, Timeline::now());
+		}
+		if (ret == ALGO_RUN_RETRY) {
+			// Nothing completed (e.g. ping-pong peer silent), neither a loop nor an error
+			continue;
+		}
+		if (paceRate != 0) {
+			// bytes / (MB/s) gives microseconds
+			paceBytes += mpAlgo->get_bytes_per_run();
+			std::this_thread::sleep_until(paceBegin + std::chrono::microseconds(paceBytes / paceRate));
+		}
 		if (ret == 0) {
-			mLoops++;
+			// Single writer, a plain store is enough for control plane readers
+			loopsCounter.store(++loops, std::memory_order_relaxed);
 		} else {
-			mState = TrafficGeneratorStateStopError;
+			mpHot->control.state = TrafficGeneratorStateStopError;
+		}
+		if (mpLiveSlot) {
+			publishLive(Timeline::now() - begin, mpAlgo->get_bytes_per_run(), mpAlgo->get_accesses_per_run());
+		}
+		if (ret != 0) {
 			break;
 		}
 
-	} while (mState == TrafficGeneratorStateExecuting);
+	} while (control.state.load(std::memory_order_relaxed) == TrafficGeneratorStateExecuting);
+
+	if (mpLiveSlot) {
+		publishLive(0, 0, 0);
+	}
+
+	if (mpPerf) {
+		mpPerf->disable();
+	}
 
 	// Error condition
-	if (mState == TrafficGeneratorStateStopError) {
+	if (mpHot->control.state == TrafficGeneratorStateStopError) {
 		mLogger->report_failure("Error found during core threads verify stage.");
 		mErrCode = -1;
 		//return -1;
 		return 0;
-	} else if (mState == TrafficGeneratorStateStop) {
+	} else if (mpHot->control.state == TrafficGeneratorStateStop) {
 		mLogger->print("No error detected while running.", CPU_GENERATOR_LOGGER_ID);
 		mErrCode = 0;
 	} else {
-		mLogger->report_failure("State machine error found.  mState=" + std::to_string(mState));
+		mLogger->report_failure("State machine error found.  mState=" + std::to_string(mpHot->control.state));
 	}
 
 	return 0;
@@ -129,7 +261,73 @@ void CpuTrafficGenerator::setAlgorithm(std::shared_ptr<IAlgorithm> algo)
 	mpAlgo = std::move(algo);
 }
 
+void CpuTrafficGenerator::setTimeline(std::shared_ptr<TimelineBuffer> buffer)
+{
+	mpAlgo->setTimeline(buffer);
+	mpTimeline = std::move(buffer);
+}
+
+void CpuTrafficGenerator::replaceAlgorithm(std::shared_ptr<IAlgorithm> algo)
+{
+	std::lock_guard<std::mutex> lock(mPendingMutex);
+	mpPendingAlgo = std::move(algo);
+	mpHot->control.pending.store(true, std::memory_order_release);
+}
+
+void CpuTrafficGenerator::applyPending()
+{
+	std::lock_guard<std::mutex> lock(mPendingMutex);
+	if (mpTimeline) {
+		mpPendingAlgo->setTimeline(mpTimeline);
+	}
+	std::atomic_store(&mpAlgo, std::move(mpPendingAlgo));
+	mpPendingAlgo.reset();
+	mpHot->control.pending = false;
+}
+
+void CpuTrafficGenerator::publishLive(uint64_t iterationNs, uint64_t bytes, uint64_t accesses)
+{
+	// Single writer: plain loads of our own values, relaxed stores inside the seqlock
+	const auto relaxed = std::memory_order_relaxed;
+	live_write_begin(mpLiveSlot);
+	mpLiveSlot->state.store(mpHot->control.state.load(relaxed), relaxed);
+	mpLiveSlot->active.store(mpHot->control.active.load(relaxed), relaxed);
+	mpLiveSlot->loops.store(mpHot->counters.loops.load(relaxed), relaxed);
+	mpLiveSlot->errors.store((mpHot->control.state == TrafficGeneratorStateStopError) ? 1 : 0, relaxed);
+	if (iterationNs != 0) {
+		auto & bucket = mpLiveSlot->latency[live_latency_bucket(iterationNs)];
+		bucket.store(bucket.load(relaxed) + 1, relaxed);
+		mpLiveSlot->bytes.store(mpLiveSlot->bytes.load(relaxed) + bytes, relaxed);
+		mpLiveSlot->accesses.store(mpLiveSlot->accesses.load(relaxed) + accesses, relaxed);
+		mpLiveSlot->last_ns.store(iterationNs, relaxed);
+	}
+	live_write_end(mpLiveSlot);
+}
+
+void CpuTrafficGenerator::setRate(uint64_t mbps)
+{
+	mpHot->control.rate = mbps;
+}
+
+uint64_t CpuTrafficGenerator::getRate()
+{
+	return mpHot->control.rate;
+}
+
 void CpuTrafficGenerator::setAffinity(uint32_t apicid)
 {
 	mApicId = apicid;
+	// The generator thread is pinned to apicid, keep its hot state on that node
+	placeHotState((numa_available() >= 0) ? numa_node_of_cpu(apicid) : -1);
+}
+
+void CpuTrafficGenerator::enablePerfCounters(std::vector<uint64_t> rawEvents)
+{
+	mPerfEnabled = true;
+	mPerfRawEvents = std::move(rawEvents);
+}
+
+std::shared_ptr<PerfCounters> CpuTrafficGenerator::getPerfCounters()
+{
+	return mpPerf;
 }
@@ -9,8 +9,10 @@
 #include "ITrafficGenerator.h"
 #include "algo/IAlgorithm.h"
 #include "utils/Logger.h"
+#include "utils/PerfCounters.h"
 #include "AddressList.h"
 
+#include <mutex>
 #include <pthread.h>
 
 /**
@@ -24,6 +26,21 @@ class CpuTrafficGenerator : public ITrafficGenerator
 		const uint32_t mAnyApicId = 0xFFFFFFFF;
 		uint32_t mApicId = mAnyApicId;
 		ret_t mErrCode = 0;
+		bool mPerfEnabled = false;
+		std::vector<uint64_t> mPerfRawEvents;
+		std::shared_ptr<PerfCounters> mpPerf;
+		std::mutex mPendingMutex;
+		std::shared_ptr<IAlgorithm> mpPendingAlgo;
+
+		/**
+		 * @brief Applies a pending algorithm, called between iterations only.
+		 */
+		void applyPending(void);
+
+		/**
+		 * @brief Publishes counters to the live slot, iterationNs of 0 updates state only.
+		 */
+		void publishLive(uint64_t iterationNs, uint64_t bytes, uint64_t accesses);
 
 	public:
 		/**
@@ -38,21 +55,21 @@ class CpuTrafficGenerator : public ITrafficGenerator
 		CpuTrafficGenerator(std::shared_ptr<AddressList> addrList);
 
 		/**
-		 * @brief 
+		 * @brief Marks the generator active so it issues traffic as soon as it is started.
 		 * 
 		 * @return 0
 		 */
 		virtual ret_t configure();
 
 		/**
-		 * @brief Sets mState to TrafficGeneratorState::TrafficGeneratorStateStart
+		 * @brief Sets the generator state to TrafficGeneratorState::TrafficGeneratorStateStart
 		 * 
 		 * @return 0 
 		 */
 		virtual ret_t start();
 
 		/**
-		 * @brief Sets mState to TrafficGeneratorState::TrafficGeneratorStateStop
+		 * @brief Sets the generator state to TrafficGeneratorState::TrafficGeneratorStateStop
 		 * 
 		 * @return 0 
 		 */
@@ -75,13 +92,24 @@ class CpuTrafficGenerator : public ITrafficGenerator
 		virtual ret_t task();
 
 		/**
-		 * @brief Prints a line with the values of  mApicId and mLoops 
+		 * @brief Prints a line with the values of  mApicId and the loop count, followed by the algorithm report, perf counters
+		 * and derived metrics (IPC, misses and cycles per access) when counters are enabled.
 		 */
 		virtual void print();
 
 
 		virtual void dump();
 
+		/**
+		 * @return Bytes moved by one algorithm iteration.
+		 */
+		virtual uint64_t getBytesPerLoop(void);
+
+		/**
+		 * @return Accesses issued by one algorithm iteration.
+		 */
+		virtual uint64_t getAccessesPerLoop(void);
+
 		/**
 		 * @brief Setter function for the address list
 		 *
@@ -96,10 +124,44 @@ class CpuTrafficGenerator : public ITrafficGenerator
 		 */
 		void setAlgorithm(std::shared_ptr<IAlgorithm> algo);
 
+		/**
+		 * @brief Records iteration spans into buffer and hands it to the algorithm for stage spans.
+		 * Must be called after setAlgorithm().
+		 */
+		virtual void setTimeline(std::shared_ptr<TimelineBuffer> buffer);
+
+		/**
+		 * @brief Replaces the algorithm at the next iteration boundary, a running iteration is never cut short.
+		 * The new algorithm must already hold its address list.
+		 */
+		void replaceAlgorithm(std::shared_ptr<IAlgorithm> algo);
+
+		/**
+		 * @brief Paces iterations to at most mbps MB/s from the next iteration on, 0 removes the limit.
+		 */
+		void setRate(uint64_t mbps);
+
+		/**
+		 * @return Bandwidth limit in MB/s, 0 when unthrottled.
+		 */
+		uint64_t getRate(void);
+
 		/**
 		 * @brief Setter function for affinity
 		 *
 		 * @param apicid 
 		 */
 		void setAffinity(uint32_t apicid);
+
+		/**
+		 * @brief Collects perf_event counters on the generator thread during the execution loop.
+		 *
+		 * @param rawEvents Raw PMU event codes collected on top of the default group.
+		 */
+		void enablePerfCounters(std::vector<uint64_t> rawEvents);
+
+		/**
+		 * @return Counter group of the generator thread, nullptr if perf counters are disabled.
+		 */
+		std::shared_ptr<PerfCounters> getPerfCounters(void);
 };
@@ -20,6 +20,7 @@
 
 #include "DeviceTrafficGenerator.h"
 #include "algo/MulWrStream.h"
+#include "cxl/CxlAddressMap.h"
 
 extern "C" {
 #include <pci/pci.h>
@@ -34,6 +35,7 @@ extern "C" {
 #define CONFIG_ALGO_SETTING_OFF                                0x30
 #define DEVICE_AFU_STATUS1_OFF                                 0x98
 #define DEVICE_GENERATOR_LOGGER_ID                             50
+#define DEVICE_LOOPS_POLL_MS                                   1
 #define TC1BF                            {"Self Checking Supported",\
                                           "Algorithm 1a Supported",\
                                           "Algorithm 1b Supported",\
@@ -421,15 +423,24 @@ ret_t DeviceTrafficGenerator::configure()
 	*(uint64_t*)((char*)mVirtAddr + CONFIG_ALGO_SETTING_OFF) = Register7;
     // Clear errors
     *(uint64_t*)((char*)mVirtAddr + DEV_CAP_ERRORLOG3) = 0x0;
+    // The AFU counts loops from 0 once started
+    mLoopsTotal = 0;
+    mLoopsRaw = 0;
 
     mLogger->log_action("CCV AFU configuration completed.", DEVICE_GENERATOR_LOGGER_ID, this->mBus);
+    mpHot->control.active = true;
 	return 0;
 }
 
 ret_t DeviceTrafficGenerator::start()
 {
     mLogger->log_action("Start.", DEVICE_GENERATOR_LOGGER_ID, this->mBus);
-	*(uint64_t*)((char*)mVirtAddr + 0x30) |= 0x1;
+    mpHot->control.state = TrafficGeneratorStateStart;
+    // Inactive devices are kicked off later by the phase scheduler
+    if (!mpHot->control.active) {
+        return 0;
+    }
+	*(uint64_t*)((char*)mVirtAddr + CONFIG_ALGO_SETTING_OFF) |= 0x1;
     mLogger->log_action("Device is running.", DEVICE_GENERATOR_LOGGER_ID, this->mBus);
 	return 0;
 }
@@ -437,10 +448,70 @@ ret_t DeviceTrafficGenerator::start()
 ret_t DeviceTrafficGenerator::stop()
 {
     mLogger->log_action("Stopping.", DEVICE_GENERATOR_LOGGER_ID, this->mBus);
-	*(uint64_t*)((char*)mVirtAddr + 0x30) &= (0xFFFFFFFFFFFFFFF8);
+    mpHot->control.state = TrafficGeneratorStateStop;
+	*(uint64_t*)((char*)mVirtAddr + CONFIG_ALGO_SETTING_OFF) &= (0xFFFFFFFFFFFFFFF8);
 	return 0;
 }
 
+ret_t DeviceTrafficGenerator::setActive(bool active)
+{
+    bool wasActive = mpHot->control.active.exchange(active);
+
+    // Only toggle the AFU while the test is running, start() handles the first kick off, a hold resumes it on release
+    if (mpHot->control.state != TrafficGeneratorStateStart || wasActive == active || mpHot->control.holds != 0) {
+        return 0;
+    }
+
+    if (active) {
+        *(uint64_t*)((char*)mVirtAddr + CONFIG_ALGO_SETTING_OFF) |= 0x1;
+        mLogger->log_action("Device resumed.", DEVICE_GENERATOR_LOGGER_ID, this->mBus);
+    } else {
+        *(uint64_t*)((char*)mVirtAddr + CONFIG_ALGO_SETTING_OFF) &= (0xFFFFFFFFFFFFFFF8);
+        mLogger->log_action("Device paused.", DEVICE_GENERATOR_LOGGER_ID, this->mBus);
+    }
+    return 0;
+}
+
+void DeviceTrafficGenerator::hold(bool on)
+{
+    uint32_t holds = on ? ++mpHot->control.holds : --mpHot->control.holds;
+    uint64_t epoch = on ? ++mpHot->control.hold_epoch : mpHot->control.hold_epoch.load();
+    bool running = mpHot->control.state == TrafficGeneratorStateStart && mpHot->control.active;
+    // First hold pauses the AFU, last release resumes it, clearing the run bit is taken as the AFU being idle
+    if (on && holds == 1 && running) {
+        *(uint64_t*)((char*)mVirtAddr + CONFIG_ALGO_SETTING_OFF) &= (0xFFFFFFFFFFFFFFF8);
+    } else if (!on && holds == 0 && running) {
+        *(uint64_t*)((char*)mVirtAddr + CONFIG_ALGO_SETTING_OFF) |= 0x1;
+    }
+    mpHot->control.held_epoch = epoch;
+}
+
+uint64_t DeviceTrafficGenerator::accumulateLoops()
+{
+	std::lock_guard<std::mutex> guard(mLoopsLock);
+	uint64_t deviceStatusReg1 = *(uint64_t*)((char*)mVirtAddr + DEVICE_AFU_STATUS1_OFF);
+	uint8_t raw = (deviceStatusReg1 >> 20) & 0xFF;
+	mLoopsTotal += (uint8_t)(raw - mLoopsRaw);
+	mLoopsRaw = raw;
+	return mLoopsTotal;
+}
+
+uint64_t DeviceTrafficGenerator::getLoops()
+{
+	return accumulateLoops();
+}
+
+uint64_t DeviceTrafficGenerator::getBytesPerLoop()
+{
+	// Algorithm 1a writes every address and then reads it back for self checking
+	return 2 * mpAddrList->GetEntrySize() * mSize;
+}
+
+uint64_t DeviceTrafficGenerator::getAccessesPerLoop()
+{
+	return 2 * mpAddrList->GetEntrySize();
+}
+
 void DeviceTrafficGenerator::dump()
 {
     std::stringstream ss;
@@ -480,7 +551,9 @@ ret_t DeviceTrafficGenerator::check()
 		ss << std::endl << std::hex << "| - Expected pattern : 0x" << expectedPattern << std::endl;
 		ss << "| - Actual pattern : 0x" << actualPattern << std::endl;
         ss << "| - ByteOffset: 0x" << ByteOffst << std::endl;
-        ss << std::dec <<"| - LoopNum: " << LoopNum;
+        ss << std::dec <<"| - LoopNum: " << LoopNum << std::endl;
+		// The AFU logs no address, the byte is on one of the lines it checks
+		ss << "| - Candidates: " << CxlAddressMap::build()->describe_lines(mpAddrList->GetListPtr(), mpAddrList->GetEntrySize(), ByteOffst);
 		mLogger->print(ss.str(), 1000);
 		return -1;
 	}
@@ -506,13 +579,24 @@ ret_t DeviceTrafficGenerator::check()
 
 ret_t DeviceTrafficGenerator::task()
 {
-    return 0;
+	// The AFU loop counter is 8 bits wide, polling it often keeps the 64-bit total from missing a wrap
+	// Only this thread records poll spans, the timeline buffer has a single writer
+	while (mpHot->control.state != TrafficGeneratorStateStop) {
+		bool sampled = mpTimeline && mpTimeline->begin_iteration();
+		uint64_t begin = sampled ? Timeline::now() : 0;
+		uint64_t loops = accumulateLoops();
+		if (sampled) {
+			mpTimeline->record(TimelineSpanPoll, begin, Timeline::now(), loops);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(DEVICE_LOOPS_POLL_MS));
+	}
+	accumulateLoops();
+	return 0;
 }
 
 void DeviceTrafficGenerator::print()
 {
-	uint64_t deviceStatusReg1 = *(uint64_t*)((char*)mVirtAddr + DEVICE_AFU_STATUS1_OFF);
-	mLogger->print("bus: " + std::to_string(mBus) + ", loops: " + std::to_string((deviceStatusReg1 >> 20) & 0xFF), DEVICE_GENERATOR_LOGGER_ID);
+	mLogger->print("bus: " + std::to_string(mBus) + ", loops: " + std::to_string(getLoops()), DEVICE_GENERATOR_LOGGER_ID);
 }
 
 
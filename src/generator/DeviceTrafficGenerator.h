@@ -7,6 +7,7 @@
 
 #pragma once
 #include <vector>
+#include <mutex>
 
 #include "ITrafficGenerator.h"
 #include "algo/IAlgorithm.h"
@@ -31,6 +32,11 @@ class DeviceTrafficGenerator : public ITrafficGenerator
 		uint16_t mLoops = 0;
 		uint16_t mProtocol = 0;
 		uint8_t mStartAddressCacheAligned = 0;
+		// 64-bit total of the 8-bit AFU loop counter, accumulated from wrapped deltas
+		std::mutex mLoopsLock;
+		uint64_t mLoopsTotal = 0;
+		uint8_t mLoopsRaw = 0;
+		uint64_t accumulateLoops(void);
 		void *mVirtAddr  = (void *) 0;
 		void iterate_register(uint32_t raw_register, std::vector<std::string>& bit_fields);
 		unsigned long long int MapPhyMemToVirtMem(uint64_t PhysicalAddrCopy, off_t MemorySpanCopy);
@@ -53,6 +59,11 @@ class DeviceTrafficGenerator : public ITrafficGenerator
 		virtual ret_t task();
 		virtual void print();
 		virtual void dump();
+		virtual ret_t setActive(bool active);
+		virtual void hold(bool on);
+		virtual uint64_t getLoops(void);
+		virtual uint64_t getBytesPerLoop(void);
+		virtual uint64_t getAccessesPerLoop(void);
 		//
 		void setAddressList(std::shared_ptr<AddressList> addrList);
 		void setAlgorithm(std::shared_ptr<IAlgorithm> algo);
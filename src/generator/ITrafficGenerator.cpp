@@ -5,8 +5,105 @@
 
 **/
 
+#include <new>
+#include <cstdlib>
+
 #include "ITrafficGenerator.h"
 
+extern "C"
+{
+    #include <numa.h>
+}
+
+static GeneratorHotState* alloc_hot_state(int node) {
+    void* block = nullptr;
+    if (numa_available() >= 0) {
+        // Whole pages, nothing else ever lands next to the block
+        block = (node >= 0) ? numa_alloc_onnode(sizeof(GeneratorHotState), node) : numa_alloc_local(sizeof(GeneratorHotState));
+    }
+    if (block == nullptr) {
+        block = aligned_alloc(GENERATOR_HOT_ALIGN, sizeof(GeneratorHotState));
+    }
+    return new (block) GeneratorHotState();
+}
+
+static void free_hot_state(GeneratorHotState* hot) {
+    hot->~GeneratorHotState();
+    if (numa_available() >= 0) {
+        numa_free(hot, sizeof(GeneratorHotState));
+    } else {
+        free(hot);
+    }
+}
+
 ITrafficGenerator::ITrafficGenerator() {
     mLogger = Logger::build();
-}
\ No newline at end of file
+    mpHot = alloc_hot_state(-1);
+    mpHot->control.state = TrafficGeneratorStateReset;
+}
+
+ITrafficGenerator::~ITrafficGenerator() {
+    free_hot_state(mpHot);
+}
+
+void ITrafficGenerator::placeHotState(int node) {
+    GeneratorHotState* hot = alloc_hot_state(node);
+    hot->counters.loops = mpHot->counters.loops.load();
+    hot->control.state = mpHot->control.state.load();
+    hot->control.active = mpHot->control.active.load();
+    hot->control.pending = mpHot->control.pending.load();
+    hot->control.rate = mpHot->control.rate.load();
+    hot->control.holds = mpHot->control.holds.load();
+    hot->control.hold_epoch = mpHot->control.hold_epoch.load();
+    hot->control.held_epoch = mpHot->control.held_epoch.load();
+    free_hot_state(mpHot);
+    mpHot = hot;
+    mHotNode = node;
+}
+
+ret_t ITrafficGenerator::setActive(bool active) {
+    mpHot->control.active = active;
+    return 0;
+}
+
+bool ITrafficGenerator::isActive(void) {
+    return mpHot->control.active;
+}
+
+void ITrafficGenerator::hold(bool on) {
+    if (on) {
+        // holds first, a generator seeing the new epoch is bound to see the hold too
+        mpHot->control.holds++;
+        mpHot->control.hold_epoch++;
+    } else {
+        mpHot->control.holds--;
+    }
+}
+
+bool ITrafficGenerator::isHeld(void) {
+    return mpHot->control.held_epoch == mpHot->control.hold_epoch || mpHot->control.state != TrafficGeneratorStateExecuting;
+}
+
+void ITrafficGenerator::setTimeline(std::shared_ptr<TimelineBuffer> buffer) {
+    mpTimeline = std::move(buffer);
+}
+
+void ITrafficGenerator::setLiveSlot(LiveGeneratorSlot* slot) {
+    mpLiveSlot = slot;
+}
+
+TrafficGeneratorState ITrafficGenerator::getState(void) {
+    return mpHot->control.state;
+}
+
+GeneratorSnapshot ITrafficGenerator::snapshot(void) {
+    return {getLoops(), mpHot->control.state.load(std::memory_order_relaxed), mpHot->control.active.load(std::memory_order_relaxed)};
+}
+
+int ITrafficGenerator::getHotNode(void) {
+    return mHotNode;
+}
+
+uint64_t ITrafficGenerator::getLoops(void) {
+    return mpHot->counters.loops.load(std::memory_order_relaxed);
+}
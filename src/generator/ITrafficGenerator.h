@@ -10,6 +10,8 @@
 
 #include "cxl/CxlTypes.h"
 #include "utils/Logger.h"
+#include "utils/Timeline.h"
+#include "utils/LiveStats.h"
 
 //TODO: make state machine same for cpu/afu
 enum TrafficGeneratorState {    TrafficGeneratorStateReset=0, 
@@ -19,16 +21,69 @@ enum TrafficGeneratorState {    TrafficGeneratorStateReset=0,
 				TrafficGeneratorStateStopError=4
 			   };
 
+// The L2 spatial prefetcher pulls 128 byte line pairs, hot state blocks are padded to a pair
+#define GENERATOR_HOT_ALIGN    (2 * CACHELINE_SIZE)
+
+/**
+ * @brief Written by the generator thread on every iteration, never by another thread.
+ */
+typedef struct alignas(GENERATOR_HOT_ALIGN) {
+	std::atomic<uint64_t> loops;
+} GeneratorCounters;
+
+/**
+ * @brief Written by the control plane (state machine, phase scheduler, control socket), polled by the generator thread.
+ */
+typedef struct alignas(GENERATOR_HOT_ALIGN) {
+	std::atomic<TrafficGeneratorState> state;
+	std::atomic<bool> active;
+	std::atomic<bool> pending;
+	std::atomic<uint64_t> rate;
+	/* Hold requests (e.g. a page migration verifying a batch), the generator idles while any is pending. */
+	std::atomic<uint32_t> holds;
+	/* Bumped by every hold after holds, the generator copies it to held_epoch once idle for it. */
+	std::atomic<uint64_t> hold_epoch;
+	std::atomic<uint64_t> held_epoch;
+} GeneratorControl;
+
+/**
+ * @brief Per-generator state touched on every iteration, kept off the generator object so neighbouring
+ * heap objects and control plane reads never share its lines. Allocated on the node of the generator thread.
+ */
+typedef struct {
+	GeneratorCounters counters;
+	GeneratorControl control;
+} GeneratorHotState;
+
+/**
+ * @brief Copy of the hot state taken by the control plane in one pass.
+ */
+typedef struct {
+	uint64_t loops;
+	TrafficGeneratorState state;
+	bool active;
+} GeneratorSnapshot;
+
 class ITrafficGenerator
 {
 	protected:
-		uint64_t mLoops = 0;
-		std::atomic<TrafficGeneratorState> mState = TrafficGeneratorStateReset;
-		std::atomic<bool> mActive = false;
+		GeneratorHotState* mpHot = nullptr;
+		int mHotNode = -1;
 		std::shared_ptr<Logger> mLogger;
+		std::shared_ptr<TimelineBuffer> mpTimeline;
+		LiveGeneratorSlot* mpLiveSlot = nullptr;
+
+		/**
+		 * @brief Moves the hot state to node, called once the generator thread placement is known.
+		 * @param node NUMA node, -1 for the node of the calling thread.
+		 */
+		void placeHotState(int node);
 
 	public:
 		ITrafficGenerator();
+		ITrafficGenerator(const ITrafficGenerator&) = delete;
+		ITrafficGenerator& operator=(const ITrafficGenerator&) = delete;
+		virtual ~ITrafficGenerator();
 		virtual ret_t configure() = 0;
 		virtual ret_t start() = 0;
 		virtual ret_t stop() = 0;
@@ -36,4 +91,73 @@ class ITrafficGenerator
 		virtual ret_t task() = 0;
 		virtual void print() = 0;
 		virtual void dump() = 0;
+
+		/**
+		 * @brief Enables or disables traffic without stopping the generator task.
+		 * Used by the phase scheduler to move generators between phases.
+		 *
+		 * @param active True to issue traffic, false to idle.
+		 * @return 0
+		 */
+		virtual ret_t setActive(bool active);
+
+		/**
+		 * @return true if generator is issuing traffic.
+		 */
+		bool isActive(void);
+
+		/**
+		 * @brief Asks the generator to idle between iterations, independently of setActive() so phases are not disturbed.
+		 * Holds nest, traffic resumes once every hold is released.
+		 *
+		 * @param on True to add a hold, false to release one.
+		 */
+		virtual void hold(bool on);
+
+		/**
+		 * @return true once the generator issues no traffic for a pending hold, or its task is not running.
+		 */
+		bool isHeld(void);
+
+		/**
+		 * @brief Records iteration spans (core) or status polls (device) into buffer.
+		 * Must be set before the generator task starts.
+		 */
+		virtual void setTimeline(std::shared_ptr<TimelineBuffer> buffer);
+
+		/**
+		 * @brief Publishes counters to a live statistics slot, the generator thread is its only writer.
+		 * Must be set before the generator task starts.
+		 */
+		virtual void setLiveSlot(LiveGeneratorSlot* slot);
+
+		/**
+		 * @return Current state of the generator task.
+		 */
+		TrafficGeneratorState getState(void);
+
+		/**
+		 * @brief Reads loops, state and active flag together, preferred by control plane readers over separate getters.
+		 */
+		GeneratorSnapshot snapshot(void);
+
+		/**
+		 * @return NUMA node the hot state was placed on, -1 while it sits on the node of the constructing thread.
+		 */
+		int getHotNode(void);
+
+		/**
+		 * @return Number of completed algorithm iterations.
+		 */
+		virtual uint64_t getLoops(void);
+
+		/**
+		 * @return Bytes read and written by a single iteration.
+		 */
+		virtual uint64_t getBytesPerLoop(void) = 0;
+
+		/**
+		 * @return Memory accesses (reads, writes and flushes) issued by a single iteration.
+		 */
+		virtual uint64_t getAccessesPerLoop(void) = 0;
 };
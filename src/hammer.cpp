@@ -9,9 +9,13 @@
 
 #include "utils/Logger.h"
 #include "utils/Parser.h"
+#include "utils/IsaKernels.h"
+#include "utils/Snapshot.h"
 #include "cxl/CxlTypes.h"
 #include "AddressList.h"
 #include "Test.h"
+#include "Control.h"
+#include "Daemon.h"
 
 int main(int argc, char** argv)
 {
@@ -26,42 +30,106 @@ int main(int argc, char** argv)
     logger->verbose(0);
     // print welcome message, be nice :)
     logger->print("CXLStressTester version 0.1 (WM).", 201);
+    // select ISA variant of memory kernels for this platform
+    IsaKernels::build();
 
     // catch any hammer file regex exceptions
     try {
       // parse strings which command from command line when CXLStressTester is executed
       parser->parse_command_line(argc, argv);
+      // offline snapshot comparison, no hammer file needed
+      if (!parser->diff_files.empty()) {
+        Snapshot snapshot;
+        int64_t mismatches = (parser->diff_files.size() == 2) ?
+            snapshot.diff(parser->diff_files[0], parser->diff_files[1]) : snapshot.diff_expected(parser->diff_files[0]);
+        return (mismatches == 0) ? 0 : -1;
+      }
+      // CXL topology report, no hammer file needed
+      if (parser->show_topology) {
+        parser->get_topology()->print();
+        return 0;
+      }
+      // serve hammer files on pooled targets until shut down
+      if (!parser->daemon_socket.empty()) {
+        Daemon daemon(parser->daemon_socket, parser->get_topology());
+        return daemon.run();
+      }
       // parse test file, store information in data structs
-      parser->parse_hammer_file(test->targets, test->threads_define);
+      parser->parse_hammer_file(test->targets, test->threads_define, test->phases);
     }
     catch (...) {
       logger->print("regex parsing error : Please fix the the hammer file", 200);
       return -1;
     }
 
-    // at this point, all parsing went okay, now save data into thread data structs
-    test->load_generators();
-
-    // configure test case
-    test->configure();
-
-    // clean memory before starting test
-    test->clear_memory();
-
-    logger->print("Press any key to start generators.", 200);
-    std::cin.get();
-
-    test->start();
-
-    logger->print("Running. Press enter to stop generators.", 200);
-    std::cin.get();
-    
-    test->stop();
+    test->perf_counters = parser->perf_counters;
+    test->perf_raw_events = parser->perf_raw_events;
+    test->timeline_file = parser->timeline_file;
+    test->timeline_events = parser->timeline_events;
+    test->live_name = parser->live_name;
+    test->converge_cv = parser->converge_cv;
+    test->converge_max_ms = parser->converge_max_ms;
+
+    test->sweeps = parser->sweeps;
+    test->sweep_point_ms = parser->sweep_point_ms;
+    test->target_geometry = parser->target_geometry;
+    test->migrations = parser->migrations;
+    test->topology = parser->get_topology();
+
+    bool result;
+    if (!test->sweeps.empty()) {
+      if (!parser->control_socket.empty()) { logger->print("Sweeps rebuild generators on their own, --control is ignored.", 200); }
+      logger->print("Press any key to start the sweep.", 200);
+      std::cin.get();
+      // every point rebuilds generators on top of the targets allocated while parsing, and verifies
+      result = test->sweep();
+      if (!test->timeline_file.empty()) { test->write_timeline(); }
+    } else {
+      // at this point, all parsing went okay, now save data into thread data structs
+      test->load_generators();
+
+      // configure test case
+      test->configure();
+
+      // clean memory before starting test
+      test->clear_memory();
+
+      logger->print("Press any key to start generators.", 200);
+      std::cin.get();
+
+      test->start();
+
+      // generators and targets can be driven from outside while running
+      std::shared_ptr<Control> control;
+      if (!parser->control_socket.empty()) {
+        control = std::make_shared<Control>(parser->control_socket, test);
+        control->start();
+      }
+
+      if (test->phases.empty() && test->converge_cv == 0) {
+        if (control) {
+          logger->print("Running. Press enter or send stop to " + parser->control_socket + " to stop generators.", 200);
+          control->wait();
+        } else {
+          logger->print("Running. Press enter to stop generators.", 200);
+          std::cin.get();
+        }
+      } else {
+        // run phase blocks, generators stop once last phase is over
+        test->run();
+      }
+
+      if (control) { control->stop(); }
+      test->stop();
+
+      if (!test->timeline_file.empty()) { test->write_timeline(); }
+
+      result = test->verify();
+    }
 
-    bool result = test->verify();
-    
     // change this to be inside the test
     if (parser->display_dump){ test->dump(); }
+    if (!parser->snapshot_file.empty()) { test->snapshot(parser->snapshot_file); }
 
     // say good bye
     logger->print("Exiting.", 201);
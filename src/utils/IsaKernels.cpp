@@ -0,0 +1,115 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <immintrin.h>
+
+#include "IsaKernels.h"
+#include "cxl/CxlTypes.h"
+
+#define ISA_LOGGER_ID          201
+
+/* x86-64 baseline, SSE2 is part of every x86-64 CPU */
+static void fill_sse2(void* dst, uint64_t value, uint64_t size) {
+    __m128i data = _mm_set1_epi64x(value);
+    char* ptr = (char*)dst;
+    for (uint64_t offset = 0; offset < size; offset += CACHELINE_SIZE) {
+        _mm_stream_si128((__m128i*)(ptr + offset), data);
+        _mm_stream_si128((__m128i*)(ptr + offset + 16), data);
+        _mm_stream_si128((__m128i*)(ptr + offset + 32), data);
+        _mm_stream_si128((__m128i*)(ptr + offset + 48), data);
+    }
+    _mm_sfence();
+}
+
+static uint64_t find_mismatch_sse2(const void* a, const void* b, uint64_t size) {
+    const char* pa = (const char*)a;
+    const char* pb = (const char*)b;
+    for (uint64_t offset = 0; offset < size; offset += CACHELINE_SIZE) {
+        __m128i diff = _mm_or_si128(
+            _mm_or_si128(_mm_xor_si128(_mm_loadu_si128((const __m128i*)(pa + offset)), _mm_loadu_si128((const __m128i*)(pb + offset))),
+                         _mm_xor_si128(_mm_loadu_si128((const __m128i*)(pa + offset + 16)), _mm_loadu_si128((const __m128i*)(pb + offset + 16)))),
+            _mm_or_si128(_mm_xor_si128(_mm_loadu_si128((const __m128i*)(pa + offset + 32)), _mm_loadu_si128((const __m128i*)(pb + offset + 32))),
+                         _mm_xor_si128(_mm_loadu_si128((const __m128i*)(pa + offset + 48)), _mm_loadu_si128((const __m128i*)(pb + offset + 48)))));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xFFFF) {
+            return offset;
+        }
+    }
+    return size;
+}
+
+__attribute__((target("avx2")))
+static void fill_avx2(void* dst, uint64_t value, uint64_t size) {
+    __m256i data = _mm256_set1_epi64x(value);
+    char* ptr = (char*)dst;
+    for (uint64_t offset = 0; offset < size; offset += CACHELINE_SIZE) {
+        _mm256_stream_si256((__m256i*)(ptr + offset), data);
+        _mm256_stream_si256((__m256i*)(ptr + offset + 32), data);
+    }
+    _mm_sfence();
+}
+
+__attribute__((target("avx2")))
+static uint64_t find_mismatch_avx2(const void* a, const void* b, uint64_t size) {
+    const char* pa = (const char*)a;
+    const char* pb = (const char*)b;
+    for (uint64_t offset = 0; offset < size; offset += CACHELINE_SIZE) {
+        __m256i diff = _mm256_or_si256(
+            _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(pa + offset)), _mm256_loadu_si256((const __m256i*)(pb + offset))),
+            _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(pa + offset + 32)), _mm256_loadu_si256((const __m256i*)(pb + offset + 32))));
+        if (!_mm256_testz_si256(diff, diff)) {
+            return offset;
+        }
+    }
+    return size;
+}
+
+__attribute__((target("avx512f")))
+static void fill_avx512(void* dst, uint64_t value, uint64_t size) {
+    __m512i data = _mm512_set1_epi64(value);
+    char* ptr = (char*)dst;
+    for (uint64_t offset = 0; offset < size; offset += CACHELINE_SIZE) {
+        _mm512_stream_si512((__m512i*)(ptr + offset), data);
+    }
+    _mm_sfence();
+}
+
+__attribute__((target("avx512f")))
+static uint64_t find_mismatch_avx512(const void* a, const void* b, uint64_t size) {
+    const char* pa = (const char*)a;
+    const char* pb = (const char*)b;
+    for (uint64_t offset = 0; offset < size; offset += CACHELINE_SIZE) {
+        __m512i va = _mm512_loadu_si512((const void*)(pa + offset));
+        __m512i vb = _mm512_loadu_si512((const void*)(pb + offset));
+        if (_mm512_cmpneq_epi64_mask(va, vb) != 0) {
+            return offset;
+        }
+    }
+    return size;
+}
+
+IsaKernels::IsaKernels() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        this->variant = "avx512";
+        this->fill = fill_avx512;
+        this->find_mismatch = find_mismatch_avx512;
+    } else if (__builtin_cpu_supports("avx2")) {
+        this->variant = "avx2";
+        this->fill = fill_avx2;
+        this->find_mismatch = find_mismatch_avx2;
+    } else {
+        this->variant = "x86-64";
+        this->fill = fill_sse2;
+        this->find_mismatch = find_mismatch_sse2;
+    }
+    Logger::build()->print("Using " + this->variant + " kernels.", ISA_LOGGER_ID);
+}
+
+std::shared_ptr<IsaKernels> IsaKernels::build() {
+    static std::shared_ptr<IsaKernels> object(new IsaKernels);
+    return object;
+}
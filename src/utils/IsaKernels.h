@@ -0,0 +1,44 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <memory>
+#include <string>
+
+#include "Logger.h"
+
+/**
+ * @brief Cache-line granular kernels compiled for several ISA levels.
+ * The variant is picked once from CPUID at startup, so one binary runs the widest
+ * vector code every platform supports (x86-64 baseline SSE2, AVX2, AVX-512).
+ */
+class IsaKernels {
+   private:
+    IsaKernels();
+    IsaKernels(const IsaKernels &) {}
+    IsaKernels &operator=(const IsaKernels &) { return *this; }
+
+   public:
+    ~IsaKernels() {}
+    static std::shared_ptr<IsaKernels> build();
+
+    /**
+     * @brief Name of the selected variant: x86-64, avx2 or avx512.
+     */
+    std::string variant;
+
+    /**
+     * @brief Fills size bytes (multiple of 64) at dst with a 64-bit value using non-temporal stores.
+     */
+    void (*fill)(void* dst, uint64_t value, uint64_t size);
+
+    /**
+     * @brief Compares size bytes (multiple of 64) of a and b.
+     * @return Byte offset of the first cache line that differs, size if both regions match.
+     */
+    uint64_t (*find_mismatch)(const void* a, const void* b, uint64_t size);
+};
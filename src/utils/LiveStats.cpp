@@ -0,0 +1,145 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <new>
+#include <cerrno>
+#include <algorithm>
+
+#include "LiveStats.h"
+
+extern "C"
+{
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+}
+
+static_assert(sizeof(LiveStatsHeader) % CACHELINE_SIZE == 0, "live stats header must fill whole cache lines");
+static_assert(sizeof(LiveGeneratorSlot) % CACHELINE_SIZE == 0, "live stats slots must not share cache lines");
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "live stats need address free atomics");
+
+LiveStats::~LiveStats() {
+    if (this->header) {
+        munmap(this->header, this->size);
+    }
+    if (this->owner) {
+        shm_unlink(this->name.c_str());
+    }
+}
+
+bool LiveStats::create(const std::string& name, std::uint32_t slots) {
+    this->name = name;
+    this->size = sizeof(LiveStatsHeader) + (std::uint64_t)slots * sizeof(LiveGeneratorSlot);
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    void* segment = (ftruncate(fd, this->size) == 0) ?
+        mmap(nullptr, this->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (segment == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return false;
+    }
+    this->owner = true;
+
+    // Zeroed by ftruncate, construct the atomics in place and publish the magic last
+    this->header = new (segment) LiveStatsHeader();
+    for (std::uint32_t idx = 0; idx < slots; idx++) {
+        new (this->slot(idx)) LiveGeneratorSlot();
+    }
+    this->header->version = LIVE_STATS_VERSION;
+    this->header->header_size = sizeof(LiveStatsHeader);
+    this->header->slot_size = sizeof(LiveGeneratorSlot);
+    this->header->slot_count = slots;
+    this->header->pid = getpid();
+    std::atomic_thread_fence(std::memory_order_release);
+    this->header->magic = LIVE_STATS_MAGIC;
+    return true;
+}
+
+bool LiveStats::open(const std::string& name) {
+    this->name = name;
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    struct stat segment_stat;
+    if (fd < 0) {
+        return false;
+    }
+    if (fstat(fd, &segment_stat) != 0 || (std::uint64_t)segment_stat.st_size < sizeof(LiveStatsHeader)) {
+        close(fd);
+        return false;
+    }
+    this->size = segment_stat.st_size;
+    void* segment = mmap(nullptr, this->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED) {
+        return false;
+    }
+    this->header = (LiveStatsHeader*)segment;
+    if (this->header->magic != LIVE_STATS_MAGIC || this->header->version != LIVE_STATS_VERSION ||
+        this->header->header_size != sizeof(LiveStatsHeader) || this->header->slot_size != sizeof(LiveGeneratorSlot) ||
+        this->size < sizeof(LiveStatsHeader) + (std::uint64_t)this->header->slot_count * sizeof(LiveGeneratorSlot)) {
+        // A zero magic is a segment still being created
+        int error = (this->header->magic == 0) ? EAGAIN : EPROTO;
+        munmap(segment, this->size);
+        this->header = nullptr;
+        errno = error;
+        return false;
+    }
+    return true;
+}
+
+void LiveStats::reset(std::uint32_t used) {
+    for (std::uint32_t idx = 0; idx < this->header->slot_count; idx++) {
+        LiveGeneratorSlot* slot = this->slot(idx);
+        live_write_begin(slot);
+        for (auto * field : {&slot->hw_id, &slot->type, &slot->node, &slot->state, &slot->active, &slot->loops,
+                             &slot->bytes, &slot->accesses, &slot->errors, &slot->last_ns}) {
+            field->store(0, std::memory_order_relaxed);
+        }
+        for (auto & bucket : slot->latency) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        live_write_end(slot);
+    }
+    this->header->used_slots.store(std::min(used, this->header->slot_count), std::memory_order_relaxed);
+    this->header->generation.store(this->header->generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+LiveGeneratorSlot* LiveStats::slot(std::uint32_t idx) {
+    return (LiveGeneratorSlot*)((char*)this->header + sizeof(LiveStatsHeader)) + idx;
+}
+
+bool LiveStats::read(std::uint32_t idx, LiveGeneratorSample& sample) const {
+    const LiveGeneratorSlot* slot = (const LiveGeneratorSlot*)((const char*)this->header + sizeof(LiveStatsHeader)) + idx;
+    for (int attempt = 0; attempt < LIVE_STATS_READ_TRIES; attempt++) {
+        std::uint64_t begin = slot->sequence.load(std::memory_order_acquire);
+        if (begin & 1) {
+            continue;
+        }
+        sample.hw_id = slot->hw_id.load(std::memory_order_relaxed);
+        sample.type = slot->type.load(std::memory_order_relaxed);
+        sample.node = slot->node.load(std::memory_order_relaxed);
+        sample.state = slot->state.load(std::memory_order_relaxed);
+        sample.active = slot->active.load(std::memory_order_relaxed);
+        sample.loops = slot->loops.load(std::memory_order_relaxed);
+        sample.bytes = slot->bytes.load(std::memory_order_relaxed);
+        sample.accesses = slot->accesses.load(std::memory_order_relaxed);
+        sample.errors = slot->errors.load(std::memory_order_relaxed);
+        sample.last_ns = slot->last_ns.load(std::memory_order_relaxed);
+        for (int bucket = 0; bucket < LIVE_STATS_LATENCY_BUCKETS; bucket++) {
+            sample.latency[bucket] = slot->latency[bucket].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->sequence.load(std::memory_order_relaxed) == begin) {
+            return true;
+        }
+    }
+    return false;
+}
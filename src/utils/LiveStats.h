@@ -0,0 +1,154 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <atomic>
+#include <string>
+#include <cstdint>
+
+#include "cxl/CxlTypes.h"
+
+#define LIVE_STATS_MAGIC              0x53544154534c5843ULL
+#define LIVE_STATS_VERSION            1
+#define LIVE_STATS_DEFAULT_NAME       "/cxl_stress"
+// Bucket b counts iterations of [2^(b+SHIFT), 2^(b+SHIFT+1)) ns, the last bucket everything slower
+#define LIVE_STATS_LATENCY_BUCKETS    24
+#define LIVE_STATS_LATENCY_SHIFT      6
+// Readers give up on a slot its writer keeps busy for this many tries
+#define LIVE_STATS_READ_TRIES         64
+
+enum LiveGeneratorType { LiveGeneratorCore=0,
+                         LiveGeneratorDevice=1
+                       };
+
+/**
+ * @brief Start of the segment. generation changes whenever the slots are laid out again
+ * (a sweep point or a new test), readers restart their rates then.
+ */
+typedef struct alignas(CACHELINE_SIZE) {
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t header_size;
+    std::uint32_t slot_size;
+    std::uint32_t slot_count;
+    std::int32_t pid;
+    std::atomic<std::uint32_t> used_slots;
+    std::atomic<std::uint64_t> generation;
+} LiveStatsHeader;
+
+/**
+ * @brief Counters of one generator, written by a single thread with relaxed stores.
+ * sequence is odd while the writer updates the slot (seqlock), slots never share a cache line.
+ */
+typedef struct alignas(CACHELINE_SIZE) {
+    std::atomic<std::uint64_t> sequence;
+    std::atomic<std::uint64_t> hw_id;
+    std::atomic<std::uint64_t> type;
+    std::atomic<std::uint64_t> node;
+    std::atomic<std::uint64_t> state;
+    std::atomic<std::uint64_t> active;
+    std::atomic<std::uint64_t> loops;
+    std::atomic<std::uint64_t> bytes;
+    std::atomic<std::uint64_t> accesses;
+    std::atomic<std::uint64_t> errors;
+    std::atomic<std::uint64_t> last_ns;
+    std::atomic<std::uint64_t> latency[LIVE_STATS_LATENCY_BUCKETS];
+} LiveGeneratorSlot;
+
+/**
+ * @brief Consistent copy of a slot taken by a reader.
+ */
+typedef struct {
+    std::uint64_t hw_id;
+    std::uint64_t type;
+    std::uint64_t node;
+    std::uint64_t state;
+    std::uint64_t active;
+    std::uint64_t loops;
+    std::uint64_t bytes;
+    std::uint64_t accesses;
+    std::uint64_t errors;
+    std::uint64_t last_ns;
+    std::uint64_t latency[LIVE_STATS_LATENCY_BUCKETS];
+} LiveGeneratorSample;
+
+/**
+ * @brief Opens a slot update, the owner thread is the only writer so no read-modify-write is needed.
+ */
+inline void live_write_begin(LiveGeneratorSlot* slot) {
+    slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+/**
+ * @brief Closes a slot update, readers that overlapped it retry.
+ */
+inline void live_write_end(LiveGeneratorSlot* slot) {
+    slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * @return Latency bucket of an iteration that took ns nanoseconds.
+ */
+inline std::uint32_t live_latency_bucket(std::uint64_t ns) {
+    std::uint32_t log2 = (ns > 0) ? 63 - __builtin_clzll(ns) : 0;
+    if (log2 < LIVE_STATS_LATENCY_SHIFT) return 0;
+    return (log2 - LIVE_STATS_LATENCY_SHIFT < LIVE_STATS_LATENCY_BUCKETS) ? log2 - LIVE_STATS_LATENCY_SHIFT : LIVE_STATS_LATENCY_BUCKETS - 1;
+}
+
+/**
+ * @class LiveStats
+ * @brief Named POSIX shared memory segment with one slot per generator, read by cxl_top.
+ * The tester creates it and removes it when done, viewers map it read only.
+ */
+class LiveStats {
+   private:
+    std::string name;
+    LiveStatsHeader* header = nullptr;
+    std::uint64_t size = 0;
+    bool owner = false;
+
+   public:
+    ~LiveStats();
+
+    /**
+     * @brief Creates the segment, replacing a stale one of the same name.
+     * @param name Segment name, starting with '/'.
+     * @param slots Generator slots laid out after the header.
+     * @return false if the segment could not be created.
+     */
+    bool create(const std::string& name, std::uint32_t slots);
+
+    /**
+     * @brief Maps an existing segment read only.
+     * @return false if it does not exist (errno ENOENT), is still being created (EAGAIN) or its magic,
+     * version or layout differ (EPROTO).
+     */
+    bool open(const std::string& name);
+
+    /**
+     * @brief Clears used slots and starts a new generation, called before generators are rebuilt.
+     * @param used Slots taken by the new generators.
+     */
+    void reset(std::uint32_t used);
+
+    /**
+     * @return Writable slot idx, owner only.
+     */
+    LiveGeneratorSlot* slot(std::uint32_t idx);
+
+    /**
+     * @brief Copies slot idx consistently.
+     * @return false if the writer kept it busy for LIVE_STATS_READ_TRIES tries.
+     */
+    bool read(std::uint32_t idx, LiveGeneratorSample& sample) const;
+
+    /**
+     * @return Mapped header, nullptr before create() or open().
+     */
+    const LiveStatsHeader* get_header(void) const { return this->header; }
+};
@@ -33,6 +33,16 @@ void Logger::print(const std::string& message, int verbosity) {
         std::cout << "| (Device generator): " << message << std::endl;
     } else if (verbosity == 54) {
         std::cout << "| (CPU generator): " << message << std::endl;
+    } else if (verbosity == 56) {
+        std::cout << "| (Perf counters): " << message << std::endl;
+    } else if (verbosity == 58) {
+        std::cout << "| (Migration): " << message << std::endl;
+    } else if (verbosity == 60) {
+        std::cout << "| (Control): " << message << std::endl;
+    } else if (verbosity == 62) {
+        std::cout << "| (Daemon): " << message << std::endl;
+    } else if (verbosity == 64) {
+        std::cout << "| (Topology): " << message << std::endl;
     } else if (verbosity == 100) {
         std::cout << "| (Target): " << message << std::endl;
     } else if (verbosity == 200) {
@@ -64,7 +74,7 @@ void Logger::print_app_info(void) {
     std::cout << "| "<< std::endl;
     std::cout << "| \t--id=dec\n|\t\tAssign a decimal value to parameter to specify target ID. Parameter value cannot be duplicated."<< std::endl;
     std::cout << "| "<< std::endl;
-    std::cout << "| \t--node=dec\n|\t\tNuma node where to create the target. Host memory if node is on a socket and HDM if target is on AFU node."<< std::endl;
+    std::cout << "| \t--node=dec|cxl\n|\t\tNuma node where to create the target. Host memory if node is on a socket and HDM if target is on AFU node.\n|\t\tcxl creates the target once per node onlining a CXL region (see --topology), with ids counting up from --id."<< std::endl;
     std::cout << "| "<< std::endl;
     std::cout << "| \t--addr-start=hex\n|\t\tByte offset added to node target."<< std::endl;
     std::cout << "| "<< std::endl;
@@ -76,6 +86,11 @@ void Logger::print_app_info(void) {
     std::cout << "| "<< std::endl;
     std::cout << "| \t--addr-incr=hex\n|\t\tCache-line increment between ways."<< std::endl;
     std::cout << "| "<< std::endl;
+    std::cout << "| \t--path=file (optional)\n|\t\tMap a devdax device, hugetlbfs file or regular file instead of anonymous hugepages."<< std::endl;
+    std::cout << "| \t--page=4k|thp|2m|1g (optional)\n|\t\tPage size of anonymous memory, picked from the target size when omitted (2m up to 2 MB, 1g above)."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| \t--interleave=node:weight,node:weight,... (optional)\n|\t\tSpread anonymous pages over nodes by weight, e.g. 0:3,2:1. Uses the kernel weighted interleave policy when its weights match, explicit page placement otherwise."<< std::endl;
+    std::cout << "| "<< std::endl;
     std::cout << "| 3.- Create thread(s) (CPU or AFU)."<< std::endl;
     std::cout << "| "<< std::endl;
     //std::cout << "| --define-thread --type= --hwid= --algorithm=MulWr --algo-params= --offset= --size= --pattern= --patternsize= --setloops= --patternparam= --cachealigned= --target="<< std::endl;
@@ -86,6 +101,12 @@ void Logger::print_app_info(void) {
     std::cout << "| \t--hwid=dec\n|\t\tCpu id if type=core. Device BDF if type=device."<< std::endl;
     std::cout << "| "<< std::endl;
     std::cout << "| \t--algorithm=MulWr\n|\t\tCCV AFU Algorithm1a supported only."<< std::endl;
+    std::cout << "| \t--algorithm=Trace (core only)\n|\t\tReplay the binary trace given with --trace=file. --trace-timing=1 keeps the recorded gaps."<< std::endl;
+    std::cout << "| \t--algorithm=AtomicXadd, AtomicCmpxchg or AtomicXchg (core only)\n|\t\tLocked read-modify-write loop at --offset of each target line. --lines=dec limits the shared lines."<< std::endl;
+    std::cout << "| \t--algorithm=PingPong (core only)\n|\t\tCache line ping-pong with the core thread given by --peer=hwid, the lower hw id reports round trip latency."<< std::endl;
+    std::cout << "| \t--algorithm=StreamCopy, StreamScale, StreamAdd or StreamTriad (core only)\n|\t\tSTREAM kernel from the source targets into the first target. --stream-store=temporal, nt or movsb (copy only)."<< std::endl;
+    std::cout << "| \t--algorithm=Mix (core only)\n|\t\tInterleaved reads, writes and flushes over the target addresses at --mix=reads:writes[:flushes]."<< std::endl;
+    std::cout << "| \t--algorithm=Chase (core only)\n|\t\tDependent loads over the target lines in a random cycle, links are written at --offset. Measures load-to-use latency."<< std::endl;
     std::cout << "| "<< std::endl;
     std::cout << "| \t--algo-params=hex\n|\t\tOnly for device-thread. Bit[0-3] WriteSemnticsOpcode. Bit[4-7] VerifyReadSemanticsOpcode."<< std::endl;
     std::cout << "| "<< std::endl;
@@ -103,11 +124,47 @@ void Logger::print_app_info(void) {
     std::cout << "| "<< std::endl;
     std::cout << "| \t--cachealigned=dec\n|\t\t"<< std::endl;
     std::cout << "| "<< std::endl;
-    std::cout << "| \t--target=dec\n|\t\tSpecify target id from defined targets."<< std::endl;
+    std::cout << "| \t--target=dec or --target=dec,dec,...\n|\t\tSpecify target id from defined targets. Stream kernels take the destination first, then the sources."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| 4.- Optionally create phase(s). Without phases generators run until enter is pressed."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| --define-phase"<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| \t--id=dec\n|\t\tPhase ID. Phases run in ascending id order."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| \t--duration=dec\n|\t\tPhase duration in milliseconds."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| \t--threads=dec,dec,... or --threads=none\n|\t\tHw ids of threads issuing traffic during the phase, the rest stay idle."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| 5.- Optionally sweep parameters. Every combination of the swept values runs in one process, targets are allocated once."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| --define-sweep"<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| \t--param=offset|size|threads|num-sets|set-offset-incr|num-addr-incr|addr-incr|page|interleave\n|\t\tThread switch applied to every thread, target switch applied to every target, number of busy threads, page size of every anonymous target, or weights of every interleaved target (e.g. 3:1, in node order)."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| \t--values=val,val,...\n|\t\tValues written like the switch in its definition (hex for set-offset-incr and addr-incr)."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| \t--duration=dec\n|\t\tOptional point duration in milliseconds when no phases are defined (default 2000)."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| 6.- Optionally migrate pages of a target between two nodes while generators run."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| --define-migration"<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| \t--target=dec\n|\t\tTarget id whose pages are moved."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| \t--nodes=dec,dec\n|\t\tNode pair, e.g. DRAM and CXL. Every selected page moves to the node it is not on."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| \t--fraction=float\n|\t\tOptional share of the target pages moved on every burst, 0 < fraction <= 1 (default 1)."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| \t--rate=dec\n|\t\tOptional pages per second while moving, 0 moves as fast as the kernel allows (default 0)."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| \t--on=dec --off=dec\n|\t\tOptional milliseconds of moving and of idling, alternated until the test stops (default 1000 each)."<< std::endl;
+    std::cout << "| "<< std::endl;
+    std::cout << "| \t--verify=0|1\n|\t\tCompare page contents across every move, generators are held while a batch moves, any change fails the test (default 1)."<< std::endl;
     std::cout << "| "<< std::endl;
     std::cout << "| Example:"<< std::endl;
     std::cout << "| "<< std::endl;
-    std::cout << "| 4.- Run application providing your hammer file as test parameter."<< std::endl;
+    std::cout << "| 7.- Run application providing your hammer file as test parameter."<< std::endl;
     std::cout << "| \t`CXLStressTesterr *.hammer`"<< std::endl;
     std::cout << "| "<< std::endl;
     std::cout << "+--------------------------------------------------------------------------------------------------------+" << std::endl;
@@ -124,12 +181,25 @@ void Logger::print_helper(void) {
     std::cout << "| \t-h, --help\tDisplay help center."<< std::endl;
     std::cout << "| \t-i, --info\tDisplay application detailed information."<< std::endl;
     std::cout << "| \t-d, --dump\tPrint memory dump from targets created in .hammer test file."<< std::endl;
+    std::cout << "| \t--snapshot=file\tWrite a binary snapshot of every target after the test."<< std::endl;
+    std::cout << "| \t--diff=a[,b]\tPrint cache lines that differ between snapshots a and b, or between a and the patterns its MulWr threads store."<< std::endl;
+    std::cout << "| \t--perf[=0xraw,...]\tCollect cycles, instructions, LLC and dTLB misses plus optional raw PMU events per core thread."<< std::endl;
+    std::cout << "| \t--converge=cv[,max_s]\tRun each phase until the loop rate coefficient of variation of every active thread is below cv (e.g. 0.02), at most max_s seconds (default 60)."<< std::endl;
+    std::cout << "| \t--pages[=4k,thp,2m,1g]\tRun the hammer file once per page size with identical address lists, bandwidth, latency and dTLB misses side by side."<< std::endl;
+    std::cout << "| \t--timeline=file[,events]\tWrite iteration, stage and device poll spans as Chrome trace JSON, at most events per thread (default 65536)."<< std::endl;
+    std::cout << "| \t--control=socket\tServe a UNIX socket to pause, resume, reconfigure and query generators while they run (send help for commands)."<< std::endl;
+    std::cout << "| \t--live[=/name]\tPublish per-thread counters in a shared memory segment (default /cxl_stress) for cxl_top to display while the test runs."<< std::endl;
+    std::cout << "| \t--topology\tPrint CXL memdevs, regions with their interleave sets and the NUMA nodes onlining them, then exit."<< std::endl;
+    std::cout << "| \t--sysfs-root=dir\tRead the CXL topology from a captured sysfs tree instead of /sys (for --topology, --node=cxl and miscompare reports)."<< std::endl;
+    std::cout << "| \t--daemon=socket\tKeep targets allocated between hammer files submitted on a UNIX socket (submit file [run_ms], pool, shutdown), results as JSON."<< std::endl;
     std::cout << "| "<< std::endl;
     std::cout << "| "<< std::endl;
     std::cout << "| Examples: "<< std::endl;
     std::cout << "| "<< std::endl;
     std::cout << "| \tCXLStressTester test_file.hammer"<< std::endl;
     std::cout << "| \tCXLStressTester --dump test_file.hammer"<< std::endl;
+    std::cout << "| \tCXLStressTester --snapshot=run.snap test_file.hammer"<< std::endl;
+    std::cout << "| \tCXLStressTester --diff=run.snap"<< std::endl;
     std::cout << "| "<< std::endl;
     std::cout << "+--------------------------------------------------------------------------------------------------------+" << std::endl;
 }
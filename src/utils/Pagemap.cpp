@@ -0,0 +1,59 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include "Pagemap.h"
+
+extern "C"
+{
+    #include <fcntl.h>
+    #include <unistd.h>
+}
+
+#define PAGEMAP_PRESENT       (1ULL << 63)
+#define PAGEMAP_PFN_MASK      ((1ULL << 55) - 1)
+
+Pagemap::Pagemap() {
+    this->fd = open("/proc/self/pagemap", O_RDONLY);
+}
+
+Pagemap::~Pagemap() {
+    if (this->fd >= 0) {
+        close(this->fd);
+    }
+}
+
+uint64_t Pagemap::translate(uint64_t vaddr) {
+    uint64_t entry = 0;
+    if (this->fd < 0 || pread(this->fd, &entry, sizeof(entry), (vaddr / PAGEMAP_PAGE_SIZE) * sizeof(entry)) != sizeof(entry)) {
+        return 0;
+    }
+    if (!(entry & PAGEMAP_PRESENT) || (entry & PAGEMAP_PFN_MASK) == 0) {
+        return 0;
+    }
+    return (entry & PAGEMAP_PFN_MASK) * PAGEMAP_PAGE_SIZE + (vaddr & (PAGEMAP_PAGE_SIZE - 1));
+}
+
+std::vector<uint64_t> Pagemap::translate_range(uint64_t vaddr, uint64_t size) {
+    uint64_t first = vaddr / PAGEMAP_PAGE_SIZE;
+    uint64_t pages = (vaddr + size + PAGEMAP_PAGE_SIZE - 1) / PAGEMAP_PAGE_SIZE - first;
+    std::vector<uint64_t> entries(pages, 0);
+
+    if (this->fd < 0 || pages == 0) {
+        return entries;
+    }
+
+    ssize_t length = pread(this->fd, entries.data(), pages * sizeof(uint64_t), first * sizeof(uint64_t));
+    for (uint64_t idx = 0; idx < pages; idx++) {
+        uint64_t entry = entries[idx];
+        if ((ssize_t)((idx + 1) * sizeof(uint64_t)) > length || !(entry & PAGEMAP_PRESENT)) {
+            entries[idx] = 0;
+        } else {
+            entries[idx] = (entry & PAGEMAP_PFN_MASK) * PAGEMAP_PAGE_SIZE;
+        }
+    }
+    return entries;
+}
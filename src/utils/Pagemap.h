@@ -0,0 +1,42 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "Logger.h"
+
+#define PAGEMAP_PAGE_SIZE     0x1000
+
+/**
+ * @class Pagemap
+ * @brief Translates virtual addresses of this process to host physical addresses through /proc/self/pagemap.
+ * Physical frame numbers are only visible to root, translations return 0 otherwise.
+ */
+class Pagemap {
+   private:
+    int fd = -1;
+
+   public:
+    Pagemap();
+    ~Pagemap();
+
+    /**
+     * @param vaddr Virtual address to translate.
+     * @return Host physical address, 0 if the page is not present or not visible.
+     */
+    uint64_t translate(uint64_t vaddr);
+
+    /**
+     * @brief Translates every 4 KB page of a region in a single pagemap read.
+     * @param vaddr Start of the region, rounded down to a page.
+     * @param size Size of the region in bytes.
+     * @return Physical address of each page, 0 for pages that could not be translated.
+     */
+    std::vector<uint64_t> translate_range(uint64_t vaddr, uint64_t size);
+};
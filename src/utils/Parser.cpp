@@ -9,12 +9,17 @@
 #include <fstream>
 #include <random>
 #include <array>
+#include <deque>
 
 
 #include "Parser.h"
 
 Parser::Parser() {
     this->logger = Logger::build();
+    this->target_factory = [](std::uint32_t id, std::uint16_t node, const TargetGeometry& extent, const TargetBacking& backing) {
+        return std::make_shared<Target>(id, node, extent.addr_start, extent.num_sets, extent.set_offset_incr,
+                                        extent.num_addr_incr, (extent.addr_incr << 6), backing);
+    };
 }
 
 void Parser::parse_command_line(int parameter_number, char** command_line){
@@ -42,6 +47,63 @@ void Parser::parse_command_line(int parameter_number, char** command_line){
         else if (std::regex_match(option, cmd_line, std::regex("--dump|-d"))) {
             this->display_dump = true;
         }
+        else if (std::regex_match(option, cmd_line, std::regex("--perf(=(0x[0-9a-fA-F]+(,0x[0-9a-fA-F]+)*))?"))) {
+            this->perf_counters = true;
+            std::stringstream ss_events(cmd_line[2]);
+            for (std::string raw_event; getline(ss_events, raw_event, ',');) {
+                this->perf_raw_events.push_back(std::stoull(raw_event, nullptr, 16));
+            }
+        }
+        else if (std::regex_match(option, cmd_line, std::regex("--pages(=(.+))?"))) {
+            /* Page size comparison is a page sweep around the hammer file, dTLB misses come from perf */
+            Sweep sweep = {"page", {"4k", "thp", "2m", "1g"}};
+            if (cmd_line[2].matched) {
+                sweep.values.clear();
+                std::stringstream ss_pages(cmd_line[2]);
+                for (std::string page; getline(ss_pages, page, ',');) {
+                    this->check_page(page);
+                    sweep.values.push_back(page);
+                }
+            }
+            this->sweeps.insert(this->sweeps.begin(), sweep);
+            this->perf_counters = true;
+        }
+        else if (std::regex_match(option, cmd_line, std::regex("--snapshot=(.+)"))) {
+            this->snapshot_file = cmd_line[1];
+        }
+        else if (std::regex_match(option, cmd_line, std::regex("--timeline=([^,]+)(,(\\d+))?"))) {
+            this->timeline_file = cmd_line[1];
+            if (cmd_line[3].matched) {
+                this->timeline_events = std::stoull(cmd_line[3]);
+            }
+        }
+        else if (std::regex_match(option, cmd_line, std::regex("--daemon=(.+)"))) {
+            this->daemon_socket = cmd_line[1];
+        }
+        else if (std::regex_match(option, cmd_line, std::regex("--control=(.+)"))) {
+            this->control_socket = cmd_line[1];
+        }
+        else if (std::regex_match(option, cmd_line, std::regex("--topology"))) {
+            this->show_topology = true;
+        }
+        else if (std::regex_match(option, cmd_line, std::regex("--sysfs-root=(.+)"))) {
+            this->sysfs_root = cmd_line[1];
+        }
+        else if (std::regex_match(option, cmd_line, std::regex("--live(=(/[^/]+))?"))) {
+            this->live_name = cmd_line[1].matched ? cmd_line[2].str() : LIVE_STATS_DEFAULT_NAME;
+        }
+        else if (std::regex_match(option, cmd_line, std::regex("--converge=([0-9.]+)(,(\\d+))?"))) {
+            this->converge_cv = std::stod(cmd_line[1]);
+            if (cmd_line[3].matched) {
+                this->converge_max_ms = std::stoull(cmd_line[3]) * 1000;
+            }
+        }
+        else if (std::regex_match(option, cmd_line, std::regex("--diff=([^,]+)(,(.+))?"))) {
+            this->diff_files.push_back(cmd_line[1]);
+            if (cmd_line[3].matched) {
+                this->diff_files.push_back(cmd_line[3]);
+            }
+        }
         else if (std::regex_match(option, cmd_line, std::regex(".*\\.hammer.*"))) {
             /* Set test file name. */
             this->file = option;
@@ -58,17 +120,32 @@ void Parser::parse_command_line(int parameter_number, char** command_line){
 }
 
 void Parser::parse_hammer_file(std::unordered_map<std::uint64_t, std::shared_ptr<Target>>& targets,\
-                               std::map<std::uint64_t, std::unordered_map<std::string, std::string>>& threads_define)
+                               std::map<std::uint64_t, std::unordered_map<std::string, std::string>>& threads_define,\
+                               std::map<std::uint64_t, Phase>& phases)
 {
     std::smatch param;
     std::ifstream test_file(this->file);
+    /* Lines generated from the current one, parsed before the next line of the file */
+    std::deque<std::string> expanded;
 
     this->logger->print("Using test file " + this->file, 200);
-    for(std::string line; getline(test_file, line);) {
+    // Sweeps may follow the targets they resize, read them first
+    this->parse_sweeps();
+    for(std::string line; !expanded.empty() || getline(test_file, line);) {
+        if (!expanded.empty()) {
+            line = expanded.front();
+            expanded.pop_front();
+        }
         line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
 
         // do not print if # added in beggining of line
         if (line.empty() || (std::regex_match(line, std::regex("^#.*$")))) { continue; };
+
+        /* --node=cxl: one target per CXL node, ids counting up from --id */
+        if (std::regex_search(line, std::regex("--define-target\\b")) && std::regex_search(line, std::regex("--node=cxl\\b"))) {
+            this->expand_cxl_targets(line, expanded);
+            continue;
+        }
         
         // Assign cpus to resources
         /* read cpus from numa */
@@ -78,7 +155,7 @@ void Parser::parse_hammer_file(std::unordered_map<std::uint64_t, std::shared_ptr
             total_cpus = std::stoi(param[1]);
         }
 
-        if (std::regex_match(line, param, std::regex(".*--define-(target|thread)\\b(.*)"))) {
+        if (std::regex_match(line, param, std::regex(".*--define-(target|thread|phase|sweep|migration)\\b(.*)"))) {
             /* Create target */
             if (param[1] == "target") {
                 if (!this->validate_target_switches(line)) {
@@ -127,10 +204,65 @@ void Parser::parse_hammer_file(std::unordered_map<std::uint64_t, std::shared_ptr
                 ss_addr_incr.flags(std::ios_base::hex);
                 ss_addr_incr >> addr_incr;
 
-                // building the target should not be done here
-                targets.insert({target_id, std::make_shared<Target>(target_id, node_id, 
-                                addr_start, num_sets, set_offset_incr, 
-                                num_addr_incr, (addr_incr << 6))});
+                /* Optional file backing: devdax device, hugetlbfs or regular file */
+                TargetBacking backing;
+                std::smatch backing_param;
+                if (std::regex_search(line, backing_param, std::regex("--path=(\\S+)"))) {
+                    backing.path = backing_param[1];
+                }
+                if (std::regex_search(line, backing_param, std::regex("--page=(\\S+)"))) {
+                    backing.page = backing_param[1];
+                    this->check_page(backing.page);
+                }
+                /* Optional interleave over several nodes, --interleave=node:weight,node:weight */
+                if (std::regex_search(line, backing_param, std::regex("--interleave=(\\S+)"))) {
+                    std::stringstream ss_interleave(backing_param[1].str());
+                    for (std::string entry; getline(ss_interleave, entry, ',');) {
+                        std::smatch weight;
+                        if (!std::regex_match(entry, weight, std::regex("(\\d+):(\\d+)")) ||
+                            backing.interleave.count(std::stoi(weight[1]))) {
+                            this->logger->report_failure("Malformed --interleave=" + backing_param[1].str() + ", expected node:weight,node:weight.");
+                            exit(0);
+                        }
+                        backing.interleave[std::stoi(weight[1])] = std::stoull(weight[2]);
+                    }
+                    uint64_t total = 0;
+                    for (auto & [node, weight] : backing.interleave) total += weight;
+                    if (total == 0 || !backing.path.empty()) {
+                        this->logger->report_failure("Interleave needs a non-zero weight and anonymous memory (no --path).");
+                        exit(0);
+                    }
+                }
+                /* Sweep points reshape the target in place, allocate the largest geometry any of them reaches */
+                TargetGeometry geometry = {addr_start, num_sets, set_offset_incr, num_addr_incr, addr_incr};
+                TargetGeometry extent = geometry;
+                for (auto & sweep : this->sweeps) {
+                    for (auto & value : sweep.values) {
+                        TargetGeometry point = geometry;
+                        if (!Target::SetGeometry(point, sweep.param, value)) break;
+                        extent.num_sets = std::max(extent.num_sets, point.num_sets);
+                        extent.set_offset_incr = std::max(extent.set_offset_incr, point.set_offset_incr);
+                        extent.num_addr_incr = std::max(extent.num_addr_incr, point.num_addr_incr);
+                        extent.addr_incr = std::max(extent.addr_incr, point.addr_incr);
+                    }
+                }
+                this->target_geometry[target_id] = geometry;
+
+                /* Page sweeps remap the target, start on the first page size the node can back, points lacking pages are skipped */
+                for (auto & sweep : this->sweeps) {
+                    if (sweep.param != "page" || !backing.path.empty()) continue;
+                    AddressList extent_list(extent.addr_start, extent.num_sets, extent.set_offset_incr, extent.num_addr_incr, (extent.addr_incr << 6));
+                    extent_list.GenerateAddressList();
+                    backing.page = "4k";
+                    for (auto & page : sweep.values) {
+                        if (Target::HugePagesAvailable(node_id, page, extent_list.GetSizeRequirements())) {
+                            backing.page = page;
+                            break;
+                        }
+                    }
+                }
+
+                targets.insert({target_id, this->target_factory(target_id, node_id, extent, backing)});
 
                 /* Create thread */
             } else if (param[1] == "thread"){
@@ -139,7 +271,7 @@ void Parser::parse_hammer_file(std::unordered_map<std::uint64_t, std::shared_ptr
                 }
 
                 std::smatch thread_parameters;
-                if(!std::regex_match(line, thread_parameters, std::regex("^.*(?=.*--type=(\\w+))(?=.*--hwid=(\\d+))(?=.*--algorithm=([A-Za-z0-9]*))(?=.*--algo-params=(\\w+))(?=.*--offset=(\\d+))(?=.*--size=(\\d+))(?=.*--pattern=(\\w+))(?=.*--patternsize=(\\d+))(?=.*--setloops=(\\w+))(?=.*--patternparam=(\\d+))(?=.*--cachealigned=(\\d+))(?=.*--protocol=(\\d+))(?=.*--target=(\\d+)).*$"))){
+                if(!std::regex_match(line, thread_parameters, std::regex("^.*(?=.*--type=(\\w+))(?=.*--hwid=(\\d+))(?=.*--algorithm=([A-Za-z0-9]*))(?=.*--algo-params=(\\w+))(?=.*--offset=(\\d+))(?=.*--size=(\\d+))(?=.*--pattern=(\\w+))(?=.*--patternsize=(\\d+))(?=.*--setloops=(\\w+))(?=.*--patternparam=(\\d+))(?=.*--cachealigned=(\\d+))(?=.*--protocol=(\\d+))(?=.*--target=(\\d+(?:,\\d+)*)).*$"))){
                     std::cout << "Correct the input hammer parameters! Exiting Bye! "<<std::endl;
 			        exit(1);
                 }
@@ -159,18 +291,183 @@ void Parser::parse_hammer_file(std::unordered_map<std::uint64_t, std::shared_ptr
                     threads_define[hw_id]["cachealigned"] = thread_parameters[11];
                     threads_define[hw_id]["protocol"] = thread_parameters[12];
                     threads_define[hw_id]["target"] = thread_parameters[13];
+
+                    /* Keep algorithm specific switches (e.g. --trace=) next to the common ones */
+                    std::regex option_regex("--([a-z0-9-]+)=(\\S+)");
+                    for (auto option = std::sregex_iterator(line.begin(), line.end(), option_regex); option != std::sregex_iterator(); ++option) {
+                        std::string name = (*option)[1];
+                        if (threads_define[hw_id].find(name) == threads_define[hw_id].end()) {
+                            threads_define[hw_id][name] = (*option)[2];
+                        }
+                    }
                 } else {
                         this->logger->report_failure("Unsupported thread type found.");
                         exit(0);
                 }
+                /* Create phase */
+            } else if (param[1] == "phase") {
+                if (!this->validate_phase_params(line)) {
+                    std::cout << "Correct the input hammer parameters! Exiting Bye! "<<std::endl;
+                    exit(1);
+                }
+
+                std::smatch phase_parameters;
+                std::regex_match(line, phase_parameters, std::regex("^.*(?=.*--id=(\\d+)\\b)(?=.*--duration=(\\d+)\\b)(?=.*--threads=(none|[0-9,]+)).*$"));
+
+                Phase phase;
+                phase.id = std::stoull(phase_parameters[1]);
+                phase.duration_ms = std::stoull(phase_parameters[2]);
+
+                /* Fail if same phase ID is used. */
+                if (phases.find(phase.id) != phases.end()) {
+                    throw std::runtime_error("Phase ID repeated.");
+                }
+
+                std::string thread_list = phase_parameters[3];
+                if (thread_list != "none") {
+                    std::stringstream ss_threads(thread_list);
+                    for (std::string hw_id; getline(ss_threads, hw_id, ',');) {
+                        if (!hw_id.empty()) {
+                            phase.threads.push_back(std::stoull(hw_id));
+                        }
+                    }
+                }
+                phases[phase.id] = std::move(phase);
+            } else if (param[1] == "migration") {
+                std::smatch migration_parameters;
+                if (!std::regex_match(line, migration_parameters, std::regex("^.*(?=.*--target=(\\d+)\\b)(?=.*--nodes=(\\d+),(\\d+)\\b).*$"))) {
+                    this->logger->report_failure("Migration needs --target= and --nodes=dram,cxl.");
+                    exit(0);
+                }
+                MigrationDefinition migration = {std::stoull(migration_parameters[1]),
+                                                 {std::stoi(migration_parameters[2]), std::stoi(migration_parameters[3])},
+                                                 MIGRATION_DEFAULT_FRACTION, 0, MIGRATION_DEFAULT_ON_MS, MIGRATION_DEFAULT_OFF_MS, true};
+                if (std::regex_search(line, migration_parameters, std::regex("--fraction=([0-9.]+)"))) {
+                    migration.fraction = std::stod(migration_parameters[1]);
+                }
+                if (std::regex_search(line, migration_parameters, std::regex("--rate=(\\d+)"))) {
+                    migration.rate = std::stoull(migration_parameters[1]);
+                }
+                if (std::regex_search(line, migration_parameters, std::regex("--on=(\\d+)"))) {
+                    migration.on_ms = std::stoull(migration_parameters[1]);
+                }
+                if (std::regex_search(line, migration_parameters, std::regex("--off=(\\d+)"))) {
+                    migration.off_ms = std::stoull(migration_parameters[1]);
+                }
+                if (std::regex_search(line, migration_parameters, std::regex("--verify=(\\d)"))) {
+                    migration.verify = migration_parameters[1] != "0";
+                }
+                if (migration.fraction <= 0 || migration.fraction > 1 || migration.on_ms == 0) {
+                    this->logger->report_failure("Migration needs 0 < --fraction <= 1 and --on > 0.");
+                    exit(0);
+                }
+                this->migrations.push_back(migration);
+            } else if (param[1] == "sweep") {
+                /* Already collected by parse_sweeps() */
             } else { 
-                this->logger->report_failure("Unsupported element. Please select target or thread.");
+                this->logger->report_failure("Unsupported element. Please select target, thread, phase, sweep or migration.");
                 exit(0);
             }
         }
     }
 }
 
+std::shared_ptr<CxlTopology> Parser::get_topology(void)
+{
+    if (!this->topology) {
+        this->topology = std::make_shared<CxlTopology>(this->sysfs_root);
+        this->topology->discover();
+    }
+    return this->topology;
+}
+
+void Parser::expand_cxl_targets(const std::string& line, std::deque<std::string>& expanded)
+{
+    std::smatch id;
+    if (!std::regex_search(line, id, std::regex("--id=(\\d+)\\b"))) {
+        this->logger->print("Missing switch(es): --id= ", 2);
+        std::cout << "Correct the input hammer parameters! Exiting Bye! "<<std::endl;
+        exit(1);
+    }
+    auto topology = this->get_topology();
+    std::vector<int> cxl_nodes = topology->get_cxl_nodes();
+    if (cxl_nodes.empty()) {
+        this->logger->report_failure("--node=cxl but no NUMA node onlines a CXL region under " + topology->get_root() + ", see --topology.");
+        exit(0);
+    }
+
+    std::uint64_t first_id = std::stoull(id[1]);
+    for (std::size_t idx = 0; idx < cxl_nodes.size(); idx++) {
+        std::string target = std::regex_replace(line, std::regex("--node=cxl\\b"), "--node=" + std::to_string(cxl_nodes[idx]));
+        target = std::regex_replace(target, std::regex("--id=\\d+\\b"), "--id=" + std::to_string(first_id + idx));
+        std::string regions;
+        for (auto & region : topology->get_nodes().at(cxl_nodes[idx]).regions) regions += " " + region;
+        this->logger->print("Target " + std::to_string(first_id + idx) + " on CXL node " + std::to_string(cxl_nodes[idx]) + " (" + regions.substr(1) + ").", 100);
+        expanded.push_back(target);
+    }
+}
+
+void Parser::check_page(const std::string& page)
+{
+    if (page != "4k" && page != "thp" && page != "2m" && page != "1g") {
+        this->logger->report_failure("Unsupported page size " + page + ", use 4k, thp, 2m or 1g.");
+        exit(0);
+    }
+}
+
+void Parser::parse_sweeps(void)
+{
+    static const std::vector<std::string> sweep_params = {"offset", "size", "threads", "num-sets",
+                                                          "set-offset-incr", "num-addr-incr", "addr-incr", "page", "interleave"};
+    std::smatch param;
+    std::ifstream test_file(this->file);
+
+    for (std::string line; getline(test_file, line);) {
+        line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+        if (line.empty() || std::regex_match(line, std::regex("^#.*$")) ||
+            !std::regex_match(line, std::regex(".*--define-sweep\\b.*"))) {
+            continue;
+        }
+        if (!std::regex_match(line, param, std::regex("^.*(?=.*--param=([a-z-]+))(?=.*--values=([\\w:]+(?:,[\\w:]+)*)).*$"))) {
+            this->logger->report_failure("Sweep needs --param= and --values=.");
+            exit(0);
+        }
+
+        Sweep sweep;
+        sweep.param = param[1];
+        if (std::find(sweep_params.begin(), sweep_params.end(), sweep.param) == sweep_params.end()) {
+            this->logger->report_failure("Unsupported sweep parameter " + sweep.param + ".");
+            exit(0);
+        }
+        for (auto & other : this->sweeps) {
+            if (other.param == sweep.param) {
+                this->logger->report_failure("Parameter " + sweep.param + " swept twice.");
+                exit(0);
+            }
+        }
+        std::stringstream ss_values(param[2]);
+        for (std::string value; getline(ss_values, value, ',');) {
+            if (sweep.param == "page") {
+                this->check_page(value);
+            }
+            if (sweep.param == "interleave" && !std::regex_match(value, std::regex("\\d+(:\\d+)*"))) {
+                this->logger->report_failure("Interleave sweep values are weights in node order, e.g. 3:1.");
+                exit(0);
+            }
+            // All-zero weights would place every page on the first node under an interleave label
+            if (sweep.param == "interleave" && value.find_first_of("123456789") == std::string::npos) {
+                this->logger->report_failure("Interleave needs a non-zero weight and anonymous memory (no --path).");
+                exit(0);
+            }
+            sweep.values.push_back(value);
+        }
+        if (std::regex_search(line, param, std::regex("--duration=(\\d+)"))) {
+            this->sweep_point_ms = std::stoull(param[1]);
+        }
+        this->sweeps.push_back(std::move(sweep));
+    }
+}
+
 bool Parser::validate_target_switches(std::string str){
     std::smatch param;
     std::string missingSwitches = "";
@@ -211,6 +508,28 @@ bool Parser::validate_target_switches(std::string str){
     return true;
 }
 
+bool Parser::validate_phase_params(std::string str) {
+    std::array<std::string, 3> paramList = {
+        "--id=(\\d+)",
+        "--duration=(\\d+)",
+        "--threads=(none|[0-9,]+)"
+    };
+
+    std::string missingParams = "";
+    for (auto s = paramList.begin(); s != paramList.end(); ++s) {
+        if (!std::regex_match(str, std::regex("^.*" + *s + ".*$"))) {
+            missingParams.append((*s).substr(0, (*s).find("(")) + " ");
+        }
+    }
+
+    if (missingParams.length() > 0) {
+        this->logger->print("Missing params(s): " + missingParams, 2);
+        return false;
+    }
+
+    return true;
+}
+
 std::uint64_t Parser::pick_choice(std::vector<std::pair<std::uint64_t, std::uint64_t>> weighted_choices, std::uint64_t distribution){
     for (auto& [choice, weight] : weighted_choices) {
         if (distribution < weight){
@@ -235,7 +554,7 @@ bool Parser::validate_thread_params(std::string str) {
         "--patternparam=(\\d+)",
         "--cachealigned=(\\d+)",
         "--protocol=(\\d+)",
-        "--target=(\\d+)"
+        "--target=(\\d+(?:,\\d+)*)"
     };
 
     std::string missingParams = "";
@@ -7,12 +7,18 @@
 
 #pragma once
 #include <vector>
+#include <deque>
 #include <memory>
 #include <map>
+#include <functional>
 #include <unordered_map>
 
 #include "Logger.h"
+#include "Timeline.h"
+#include "LiveStats.h"
 #include "Target.h"
+#include "cxl/CxlTopology.h"
+#include "TestTypes.h"
 
 typedef struct{
     std::uint64_t thread;
@@ -26,14 +32,45 @@ class Parser {
     std::shared_ptr<Logger> logger;
     bool validate_target_switches(std::string str);
     bool validate_thread_params(std::string str);
+    bool validate_phase_params(std::string str);
+    void parse_sweeps(void);
+    void check_page(const std::string& page);
+    void expand_cxl_targets(const std::string& line, std::deque<std::string>& expanded);
     std::uint64_t pick_choice(std::vector<std::pair<std::uint64_t, std::uint64_t>> weighted_choices, std::uint64_t distribution);
 
    public:
     bool display_dump = false;
+    bool perf_counters = false;
+    std::vector<std::uint64_t> perf_raw_events;
+    std::string snapshot_file;
+    std::string timeline_file;
+    std::string control_socket;
+    std::string live_name;
+    /* CXL topology, read on first use from sysfs_root. */
+    std::string sysfs_root = CXL_SYSFS_DEFAULT_ROOT;
+    bool show_topology = false;
+    std::shared_ptr<CxlTopology> topology;
+    std::shared_ptr<CxlTopology> get_topology(void);
+    double converge_cv = 0;
+    std::uint64_t converge_max_ms = CONVERGE_DEFAULT_MAX_MS;
+    std::uint64_t timeline_events = TIMELINE_DEFAULT_EVENTS;
+    std::vector<std::string> diff_files;
+    /* Sweep directives, targets are allocated for the largest geometry they reach. */
+    std::vector<Sweep> sweeps;
+    std::uint64_t sweep_point_ms = SWEEP_DEFAULT_POINT_MS;
+    /* Page migrations running next to the generators. */
+    std::vector<MigrationDefinition> migrations;
+    /* Target geometry as written in hammer file, sweep points override it. */
+    std::unordered_map<std::uint64_t, TargetGeometry> target_geometry;
     std::string file;
+    std::string daemon_socket;
+    /* Builds the targets of the hammer file for their largest geometry, daemon mode hands out pooled targets instead. */
+    std::function<std::shared_ptr<Target>(std::uint32_t id, std::uint16_t node, const TargetGeometry& extent,
+                                          const TargetBacking& backing)> target_factory;
     Parser();
     ~Parser(){}
     void parse_command_line(int parameter_number, char** command_line);
     void parse_hammer_file(std::unordered_map<std::uint64_t, std::shared_ptr<Target>>& targets,\
-                           std::map<std::uint64_t, std::unordered_map<std::string, std::string>>& threads_define);
+                           std::map<std::uint64_t, std::unordered_map<std::string, std::string>>& threads_define,\
+                           std::map<std::uint64_t, Phase>& phases);
 };
@@ -0,0 +1,149 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+
+#include "PerfCounters.h"
+
+extern "C"
+{
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+}
+
+#define PERF_LOGGER_ID       56
+#define HW_CACHE_MISS(cache) ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+PerfCounters::PerfCounters() {
+    this->logger = Logger::build();
+}
+
+PerfCounters::~PerfCounters() {
+    this->close_all();
+}
+
+bool PerfCounters::open_event(const std::string& name, uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = (this->leader_fd == -1) ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                       PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // pid 0 and cpu -1 follows the calling thread wherever it runs
+    int fd = syscall(__NR_perf_event_open, &attr, 0, -1, this->leader_fd, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    uint64_t id = 0;
+    ioctl(fd, PERF_EVENT_IOC_ID, &id);
+    if (this->leader_fd == -1) {
+        this->leader_fd = fd;
+    }
+    this->events.push_back({name, fd, id, 0});
+    return true;
+}
+
+void PerfCounters::close_all(void) {
+    for (auto & event : this->events) {
+        close(event.fd);
+    }
+    this->events.clear();
+    this->leader_fd = -1;
+}
+
+bool PerfCounters::open(const std::vector<uint64_t>& raw_events) {
+    this->close_all();
+    this->software = false;
+
+    if (this->open_event("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES)) {
+        this->open_event("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        this->open_event("llc-misses", PERF_TYPE_HW_CACHE, HW_CACHE_MISS(PERF_COUNT_HW_CACHE_LL));
+        this->open_event("dtlb-misses", PERF_TYPE_HW_CACHE, HW_CACHE_MISS(PERF_COUNT_HW_CACHE_DTLB));
+        for (auto & raw : raw_events) {
+            std::stringstream ss;
+            ss << "raw-0x" << std::hex << raw;
+            if (!this->open_event(ss.str(), PERF_TYPE_RAW, raw)) {
+                this->logger->print("Unable to open " + ss.str() + " perf event, skipping.", PERF_LOGGER_ID);
+            }
+        }
+    } else {
+        // No PMU access, keep going with what the kernel can count in software
+        this->logger->print("Hardware perf events unavailable (errno " + std::to_string(errno) +
+                            "), falling back to software events.", PERF_LOGGER_ID);
+        this->software = true;
+        this->open_event("task-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK);
+        this->open_event("page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+        this->open_event("context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
+        this->open_event("cpu-migrations", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS);
+    }
+
+    if (this->events.empty()) {
+        this->logger->print("Unable to open any perf event.", PERF_LOGGER_ID);
+        return false;
+    }
+    return true;
+}
+
+void PerfCounters::enable(void) {
+    if (this->leader_fd == -1) return;
+    ioctl(this->leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(this->leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounters::disable(void) {
+    if (this->leader_fd == -1) return;
+    ioctl(this->leader_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // Layout for PERF_FORMAT_GROUP | PERF_FORMAT_ID: nr, time_enabled, time_running, {value, id}[nr]
+    std::vector<uint64_t> buffer(3 + 2 * this->events.size());
+    ssize_t length = read(this->leader_fd, buffer.data(), buffer.size() * sizeof(uint64_t));
+    if (length < (ssize_t)(3 * sizeof(uint64_t))) return;
+
+    uint64_t nr = buffer[0], enabled = buffer[1], running = buffer[2];
+    double scale = (running > 0) ? (double)enabled / running : 0.0;
+    for (uint64_t idx = 0; idx < nr && idx < this->events.size(); idx++) {
+        uint64_t value = buffer[3 + 2 * idx];
+        uint64_t id = buffer[4 + 2 * idx];
+        for (auto & event : this->events) {
+            if (event.id == id) {
+                event.value = (uint64_t)(value * scale);
+            }
+        }
+    }
+}
+
+uint64_t PerfCounters::value(const std::string& name) {
+    for (auto & event : this->events) {
+        if (event.name == name) return event.value;
+    }
+    return 0;
+}
+
+bool PerfCounters::has(const std::string& name) {
+    for (auto & event : this->events) {
+        if (event.name == name) return true;
+    }
+    return false;
+}
+
+bool PerfCounters::is_software(void) {
+    return this->software;
+}
+
+const std::vector<PerfEvent>& PerfCounters::get_events(void) {
+    return this->events;
+}
@@ -0,0 +1,82 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "Logger.h"
+
+/**
+ * @brief One counter inside a perf_event group.
+ */
+typedef struct {
+    std::string name;
+    int fd;
+    uint64_t id;
+    uint64_t value;
+} PerfEvent;
+
+/**
+ * @class PerfCounters
+ * @brief Per-thread perf_event_open counter group.
+ * Opens cycles, instructions, LLC misses, dTLB misses and user given raw events for the calling thread.
+ * When hardware PMU is not reachable (VMs, restrictive perf_event_paranoid) it falls back to software events.
+ */
+class PerfCounters {
+   private:
+    std::vector<PerfEvent> events;
+    std::shared_ptr<Logger> logger;
+    bool software = false;
+    int leader_fd = -1;
+    bool open_event(const std::string& name, uint32_t type, uint64_t config);
+    void close_all(void);
+
+   public:
+    PerfCounters();
+    ~PerfCounters();
+
+    /**
+     * @brief Opens the counter group for the calling thread. Must be called from the thread to measure.
+     * @param raw_events Raw PMU event codes (event | umask << 8 | ...) added to the group.
+     * @return true if at least one counter is available.
+     */
+    bool open(const std::vector<uint64_t>& raw_events);
+
+    /**
+     * @brief Resets and starts every counter of the group.
+     */
+    void enable(void);
+
+    /**
+     * @brief Stops every counter of the group and latches their values, scaled when multiplexed.
+     */
+    void disable(void);
+
+    /**
+     * @param name Counter name (cycles, instructions, llc-misses, dtlb-misses, raw-0x...).
+     * @return Last latched value or 0 if the counter is not available.
+     */
+    uint64_t value(const std::string& name);
+
+    /**
+     * @param name Counter name.
+     * @return true if the counter was opened.
+     */
+    bool has(const std::string& name);
+
+    /**
+     * @return true if hardware counters were unavailable and software events are reported instead.
+     */
+    bool is_software(void);
+
+    /**
+     * @return Counters opened in the group.
+     */
+    const std::vector<PerfEvent>& get_events(void);
+};
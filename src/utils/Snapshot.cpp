@@ -0,0 +1,274 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <chrono>
+
+#include "Snapshot.h"
+#include "Pagemap.h"
+#include "IsaKernels.h"
+
+extern "C"
+{
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+}
+
+#define SNAPSHOT_LOGGER_ID     200
+// Chunk of target memory handed to a single write() call
+#define SNAPSHOT_WRITE_CHUNK   0x800000
+
+static uint64_t align_up(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+Snapshot::Snapshot() {
+    this->logger = Logger::build();
+}
+
+ret_t Snapshot::write(const std::string& file, std::unordered_map<std::uint64_t, std::shared_ptr<Target>>& targets,
+                      const std::vector<SnapshotThread>& threads) {
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.num_targets = targets.size();
+    header.num_threads = threads.size();
+    header.timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    Pagemap pagemap;
+    std::vector<SnapshotTarget> records;
+    std::vector<std::vector<uint64_t>> phys_tables;
+    uint64_t offset = align_up(sizeof(header) + targets.size() * sizeof(SnapshotTarget) + threads.size() * sizeof(SnapshotThread), SNAPSHOT_ALIGN);
+
+    for (auto & [id, target] : targets) {
+        auto addr_list = target->GetAddressList();
+        SnapshotTarget record;
+        record.id = id;
+        record.node = target->GetNodeID();
+        record.address = target->address;
+        record.size = align_up(target->size, CACHELINE_SIZE);
+        record.addr_start = addr_list->GetAddrStart();
+        record.num_sets = addr_list->GetNumSets();
+        record.set_offset_incr = addr_list->GetSetOffsetAddrIncr();
+        record.num_addr_incr = addr_list->GetNumAddrIncr();
+        record.addr_incr = addr_list->GetSetAddrIncr();
+        record.data_offset = offset;
+        record.phys_offset = record.data_offset + record.size;
+        phys_tables.push_back(pagemap.translate_range(target->address, record.size));
+        record.phys_pages = phys_tables.back().size();
+        offset = align_up(record.phys_offset + record.phys_pages * sizeof(uint64_t), SNAPSHOT_ALIGN);
+        records.push_back(record);
+    }
+
+    int fd = open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        this->logger->report_failure("Unable to create snapshot " + file + ": " + std::string(strerror(errno)));
+        return -1;
+    }
+
+    // Header and records first, then each target image with large sequential writes
+    std::vector<uint8_t> metadata(records.empty() ? SNAPSHOT_ALIGN : records.front().data_offset, 0);
+    memcpy(metadata.data(), &header, sizeof(header));
+    memcpy(metadata.data() + sizeof(header), records.data(), records.size() * sizeof(SnapshotTarget));
+    memcpy(metadata.data() + sizeof(header) + records.size() * sizeof(SnapshotTarget), threads.data(), threads.size() * sizeof(SnapshotThread));
+
+    bool status = pwrite(fd, metadata.data(), metadata.size(), 0) == (ssize_t)metadata.size();
+    for (std::size_t idx = 0; status && idx < records.size(); idx++) {
+        auto & record = records[idx];
+        for (uint64_t done = 0; status && done < record.size; done += SNAPSHOT_WRITE_CHUNK) {
+            uint64_t chunk = std::min<uint64_t>(SNAPSHOT_WRITE_CHUNK, record.size - done);
+            status = pwrite(fd, (const void*)(record.address + done), chunk, record.data_offset + done) == (ssize_t)chunk;
+        }
+        uint64_t phys_length = phys_tables[idx].size() * sizeof(uint64_t);
+        status = status && pwrite(fd, phys_tables[idx].data(), phys_length, record.phys_offset) == (ssize_t)phys_length;
+    }
+    close(fd);
+
+    if (!status) {
+        this->logger->report_failure("Unable to write snapshot " + file + ": " + std::string(strerror(errno)));
+        return -1;
+    }
+    this->logger->print("Snapshot of " + std::to_string(records.size()) + " target(s) written to " + file + ".", SNAPSHOT_LOGGER_ID);
+    return 0;
+}
+
+bool Snapshot::map(const std::string& file, MappedSnapshot& snapshot) {
+    struct stat file_stat;
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0 || fstat(fd, &file_stat) != 0 || (uint64_t)file_stat.st_size < sizeof(SnapshotHeader)) {
+        this->logger->report_failure("Unable to open snapshot " + file + ".");
+        if (fd >= 0) close(fd);
+        return false;
+    }
+
+    snapshot.length = file_stat.st_size;
+    snapshot.base = mmap(0, snapshot.length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (snapshot.base == MAP_FAILED) {
+        this->logger->report_failure("Unable to map snapshot " + file + ".");
+        return false;
+    }
+    madvise(snapshot.base, snapshot.length, MADV_SEQUENTIAL);
+
+    snapshot.header = (const SnapshotHeader*)snapshot.base;
+    snapshot.targets = (const SnapshotTarget*)((const char*)snapshot.base + sizeof(SnapshotHeader));
+    snapshot.threads = (const SnapshotThread*)(snapshot.targets + snapshot.header->num_targets);
+
+    if (memcmp(snapshot.header->magic, SNAPSHOT_MAGIC, sizeof(snapshot.header->magic)) != 0 ||
+        snapshot.header->version != SNAPSHOT_VERSION) {
+        this->logger->report_failure(file + " is not a version " + std::to_string(SNAPSHOT_VERSION) + " snapshot.");
+        this->unmap(snapshot);
+        return false;
+    }
+    for (uint32_t idx = 0; idx < snapshot.header->num_targets; idx++) {
+        auto & target = snapshot.targets[idx];
+        if (target.phys_offset + target.phys_pages * sizeof(uint64_t) > snapshot.length) {
+            this->logger->report_failure("Snapshot " + file + " is truncated.");
+            this->unmap(snapshot);
+            return false;
+        }
+    }
+    return true;
+}
+
+void Snapshot::unmap(MappedSnapshot& snapshot) {
+    munmap(snapshot.base, snapshot.length);
+    snapshot.base = nullptr;
+}
+
+uint64_t Snapshot::compare(const SnapshotTarget& target, const uint8_t* actual, const uint8_t* expected,
+                           const uint64_t* phys, const std::string& label_a, const std::string& label_b) {
+    auto kernels = IsaKernels::build();
+    uint64_t mismatches = 0;
+    uint64_t offset = 0;
+
+    while (offset < target.size) {
+        offset += kernels->find_mismatch(actual + offset, expected + offset, target.size - offset);
+        if (offset >= target.size) break;
+
+        std::stringstream ss;
+        const uint64_t* line_a = (const uint64_t*)(actual + offset);
+        const uint64_t* line_b = (const uint64_t*)(expected + offset);
+        uint64_t page_phys = phys[offset / PAGEMAP_PAGE_SIZE];
+        ss << std::hex << "| target " << std::dec << target.id << std::hex << " offset 0x" << offset
+           << " va 0x" << (target.address + offset);
+        if (page_phys != 0) {
+            ss << " pa 0x" << (page_phys + (offset & (PAGEMAP_PAGE_SIZE - 1)));
+        }
+        ss << "\n| " << std::setw(10) << label_a << ":";
+        for (int idx = 0; idx < 8; idx++) ss << " 0x" << std::setfill('0') << std::setw(16) << line_a[idx];
+        ss << std::setfill(' ') << "\n| " << std::setw(10) << label_b << ":";
+        for (int idx = 0; idx < 8; idx++) ss << " 0x" << std::setfill('0') << std::setw(16) << line_b[idx];
+        this->logger->print(ss.str(), 2);
+
+        mismatches++;
+        offset += CACHELINE_SIZE;
+    }
+    return mismatches;
+}
+
+int64_t Snapshot::diff(const std::string& file_a, const std::string& file_b) {
+    MappedSnapshot snapshot_a, snapshot_b;
+    if (!this->map(file_a, snapshot_a)) return -1;
+    if (!this->map(file_b, snapshot_b)) {
+        this->unmap(snapshot_a);
+        return -1;
+    }
+
+    int64_t mismatches = 0;
+    for (uint32_t idx = 0; idx < snapshot_a.header->num_targets; idx++) {
+        auto & target_a = snapshot_a.targets[idx];
+        const SnapshotTarget* target_b = nullptr;
+        for (uint32_t jdx = 0; jdx < snapshot_b.header->num_targets; jdx++) {
+            if (snapshot_b.targets[jdx].id == target_a.id) target_b = &snapshot_b.targets[jdx];
+        }
+        if (target_b == nullptr || target_b->size != target_a.size || target_b->num_sets != target_a.num_sets ||
+            target_b->set_offset_incr != target_a.set_offset_incr || target_b->num_addr_incr != target_a.num_addr_incr ||
+            target_b->addr_incr != target_a.addr_incr) {
+            this->logger->report_failure("Target " + std::to_string(target_a.id) + " geometry differs between snapshots.");
+            mismatches = -1;
+            break;
+        }
+        mismatches += this->compare(target_a, (const uint8_t*)snapshot_a.base + target_a.data_offset,
+                                    (const uint8_t*)snapshot_b.base + target_b->data_offset,
+                                    (const uint64_t*)((const char*)snapshot_a.base + target_a.phys_offset), "first", "second");
+    }
+
+    this->unmap(snapshot_a);
+    this->unmap(snapshot_b);
+    if (mismatches >= 0) {
+        this->logger->print(std::to_string(mismatches) + " mismatching cache line(s).", SNAPSHOT_LOGGER_ID);
+    }
+    return mismatches;
+}
+
+bool Snapshot::expected_image(const MappedSnapshot& snapshot, const SnapshotTarget& target, std::vector<uint8_t>& image) {
+    // Test clears every target before starting the generators
+    image.assign(target.size, 0);
+    const uint8_t* actual = (const uint8_t*)snapshot.base + target.data_offset;
+
+    for (uint32_t idx = 0; idx < snapshot.header->num_threads; idx++) {
+        auto & thread = snapshot.threads[idx];
+        if (thread.target != target.id) continue;
+        if (thread.type == SNAPSHOT_THREAD_OTHER) {
+            this->logger->report_failure("Target " + std::to_string(target.id) + " is written by hwid " + std::to_string(thread.hw_id) +
+                                         ", only MulWr stores can be modelled.");
+            return false;
+        }
+
+        // Stores MulWrStreamNew::WriteStage() issues, other write type and size pairs store nothing
+        uint8_t write_type = (thread.algo_params & 0xF0) >> 4;
+        bool writes = (thread.type == SNAPSHOT_THREAD_DEVICE) || (write_type == 1 && thread.size == 4) ||
+                      (write_type == 2 && (thread.size == 8 || thread.size == 4 || thread.size == 2 || thread.size == 1));
+        if (!writes) continue;
+
+        AddressList addr_list(target.addr_start, target.num_sets, target.set_offset_incr, target.num_addr_incr, target.addr_incr);
+        addr_list.GenerateAddressList();
+
+        // Same pattern widening as WriteStage(), narrower stores take the low bytes
+        uint64_t pattern = (thread.size == 8) ? ((thread.pattern << 32) | (thread.pattern & 0xFFFFFFFF)) : thread.pattern;
+        for (uint64_t entry = 0; entry < addr_list.GetEntrySize(); entry++) {
+            uint64_t offset = addr_list[entry] + thread.offset;
+            if (offset + thread.size > target.size) continue;
+            if (thread.type == SNAPSHOT_THREAD_DEVICE) {
+                // Device pattern sequence is not modelled, exclude its bytes
+                memcpy(image.data() + offset, actual + offset, thread.size);
+            } else {
+                memcpy(image.data() + offset, &pattern, thread.size);
+            }
+        }
+    }
+    return true;
+}
+
+int64_t Snapshot::diff_expected(const std::string& file) {
+    MappedSnapshot snapshot;
+    if (!this->map(file, snapshot)) return -1;
+
+    int64_t mismatches = 0;
+    for (uint32_t idx = 0; idx < snapshot.header->num_targets; idx++) {
+        auto & target = snapshot.targets[idx];
+        std::vector<uint8_t> expected;
+        if (!this->expected_image(snapshot, target, expected)) {
+            mismatches = -1;
+            break;
+        }
+        mismatches += this->compare(target, (const uint8_t*)snapshot.base + target.data_offset, expected.data(),
+                                    (const uint64_t*)((const char*)snapshot.base + target.phys_offset), "actual", "expected");
+    }
+
+    this->unmap(snapshot);
+    if (mismatches >= 0) {
+        this->logger->print(std::to_string(mismatches) + " mismatching cache line(s) against expected patterns.", SNAPSHOT_LOGGER_ID);
+    }
+    return mismatches;
+}
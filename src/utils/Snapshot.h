@@ -0,0 +1,120 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+#include "Logger.h"
+#include "Target.h"
+
+#define SNAPSHOT_MAGIC        "CXLSNAP"
+#define SNAPSHOT_VERSION      1
+#define SNAPSHOT_ALIGN        0x1000
+
+/**
+ * @brief File header, followed by num_targets SnapshotTarget and num_threads SnapshotThread records.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_targets;
+    uint32_t num_threads;
+    uint32_t reserved;
+    uint64_t timestamp;
+} SnapshotHeader;
+
+/**
+ * @brief Target geometry and location of its memory image inside the snapshot.
+ * Memory image is followed by the physical address of every 4 KB page (0 when not visible).
+ */
+typedef struct {
+    uint64_t id;
+    uint64_t node;
+    uint64_t address;
+    uint64_t size;
+    uint64_t addr_start;
+    uint64_t num_sets;
+    uint64_t set_offset_incr;
+    uint64_t num_addr_incr;
+    uint64_t addr_incr;
+    uint64_t data_offset;
+    uint64_t phys_offset;
+    uint64_t phys_pages;
+} SnapshotTarget;
+
+/**
+ * @brief Thread definition needed to rebuild the expected memory content.
+ */
+typedef struct {
+    uint64_t hw_id;
+    uint64_t target;
+    uint64_t type;
+    uint64_t algo_params;
+    uint64_t pattern;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t pattern_param;
+} SnapshotThread;
+
+#define SNAPSHOT_THREAD_CORE     0
+#define SNAPSHOT_THREAD_DEVICE   1
+/* Core thread running another algorithm than MulWr, its stores are not modelled. */
+#define SNAPSHOT_THREAD_OTHER    2
+
+/**
+ * @class Snapshot
+ * @brief Binary memory snapshots of targets and offline comparison.
+ * Snapshots are written with large sequential writes and compared through mmap with the ISA kernels,
+ * printing only the cache lines that differ.
+ */
+class Snapshot {
+   private:
+    std::shared_ptr<Logger> logger;
+    typedef struct {
+        void* base;
+        uint64_t length;
+        const SnapshotHeader* header;
+        const SnapshotTarget* targets;
+        const SnapshotThread* threads;
+    } MappedSnapshot;
+    bool map(const std::string& file, MappedSnapshot& snapshot);
+    void unmap(MappedSnapshot& snapshot);
+    uint64_t compare(const SnapshotTarget& target, const uint8_t* actual, const uint8_t* expected,
+                     const uint64_t* phys, const std::string& label_a, const std::string& label_b);
+    bool expected_image(const MappedSnapshot& snapshot, const SnapshotTarget& target, std::vector<uint8_t>& image);
+
+   public:
+    Snapshot();
+
+    /**
+     * @brief Streams the memory of every target to file.
+     * @param file Output snapshot file.
+     * @param targets Targets defined in hammer file.
+     * @param threads Thread definitions stored in the header for the expected-pattern model.
+     * @return 0 on success, -1 on I/O error.
+     */
+    ret_t write(const std::string& file, std::unordered_map<std::uint64_t, std::shared_ptr<Target>>& targets,
+                const std::vector<SnapshotThread>& threads);
+
+    /**
+     * @brief Prints cache lines that differ between two snapshots of the same targets.
+     * @return Number of mismatching lines, -1 if snapshots cannot be compared.
+     */
+    int64_t diff(const std::string& file_a, const std::string& file_b);
+
+    /**
+     * @brief Prints cache lines that differ from the content the snapshot threads should have written.
+     * Memory is modelled as cleared and then written by the stores of MulWr core threads. Bytes written
+     * by device threads are not modelled and are excluded from the comparison.
+     * @return Number of mismatching lines, -1 if snapshot cannot be read or a target is written by a
+     * core thread running another algorithm than MulWr.
+     */
+    int64_t diff_expected(const std::string& file);
+};
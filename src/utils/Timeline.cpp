@@ -0,0 +1,90 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+#include "Timeline.h"
+
+static const char* timeline_span_names[] = {"iteration", "flush", "write", "read", "poll", "phase"};
+
+TimelineBuffer::TimelineBuffer(const std::string& label, uint64_t tid, std::size_t capacity) {
+    this->label = label;
+    this->tid = tid;
+    // Allocated up front, recording never allocates on the generator thread
+    this->events.resize(std::max<std::size_t>(capacity, 2));
+}
+
+bool TimelineBuffer::begin_iteration(void) {
+    this->iteration++;
+    this->sampled = (this->iteration % this->stride) == 0;
+    return this->sampled;
+}
+
+void TimelineBuffer::decimate(void) {
+    std::size_t kept = 0;
+    for (std::size_t idx = 0; idx < this->count; idx++) {
+        if ((this->events[idx].iteration % (2 * this->stride)) == 0) {
+            this->events[kept++] = this->events[idx];
+        }
+    }
+    this->count = kept;
+    this->stride *= 2;
+}
+
+void TimelineBuffer::record(TimelineSpan span, uint64_t begin_ns, uint64_t end_ns, uint64_t value) {
+    // Decimation can leave the buffer full when one iteration alone overflows it, drop the span then
+    while (this->count == this->events.size() && this->stride < (1ULL << 62)) {
+        this->decimate();
+        if ((this->iteration % this->stride) != 0) {
+            this->sampled = false;
+            return;
+        }
+    }
+    if (this->count == this->events.size()) {
+        return;
+    }
+    this->events[this->count++] = {begin_ns, end_ns, this->iteration, value, span};
+}
+
+std::vector<TimelineEvent> TimelineBuffer::get_events(void) const {
+    return std::vector<TimelineEvent>(this->events.begin(), this->events.begin() + this->count);
+}
+
+uint64_t Timeline::now(void) {
+    static const auto origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+bool Timeline::write(const std::string& file, const std::vector<std::shared_ptr<TimelineBuffer>>& buffers) {
+    std::ofstream output(file);
+    if (!output.good()) {
+        return false;
+    }
+
+    // Complete ("X") events in microseconds, one track per buffer
+    output << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+    bool first = true;
+    for (auto & buffer : buffers) {
+        output << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->tid
+               << ", \"args\": {\"name\": \"" << buffer->label << "\"}}";
+        first = false;
+        for (auto & event : buffer->get_events()) {
+            output << ",\n{\"name\": \"" << timeline_span_names[event.span] << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->tid
+                   << std::fixed << std::setprecision(3) << ", \"ts\": " << event.begin_ns / 1e3
+                   << ", \"dur\": " << (event.end_ns - event.begin_ns) / 1e3
+                   << ", \"args\": {\"iteration\": " << event.iteration;
+            if (event.span == TimelineSpanPoll) output << ", \"loops\": " << event.value;
+            if (event.span == TimelineSpanPhase) output << ", \"phase\": " << event.value;
+            output << "}}";
+        }
+    }
+    output << "\n]}\n";
+    return output.good();
+}
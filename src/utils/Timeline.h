@@ -0,0 +1,100 @@
+/**
+
+  Copyright (c) 2023, Intel Corporation
+  SPDX-License-Identifier: MIT
+
+**/
+
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "cxl/CxlTypes.h"
+
+#define TIMELINE_DEFAULT_EVENTS   65536
+
+enum TimelineSpan { TimelineSpanIteration=0,
+                    TimelineSpanFlush=1,
+                    TimelineSpanWrite=2,
+                    TimelineSpanRead=3,
+                    TimelineSpanPoll=4,
+                    TimelineSpanPhase=5
+                  };
+
+/**
+ * @brief Span on the timeline, value is shown as argument (loop count for polls, id for phases).
+ */
+typedef struct {
+    uint64_t begin_ns;
+    uint64_t end_ns;
+    uint64_t iteration;
+    uint64_t value;
+    TimelineSpan span;
+} TimelineEvent;
+
+/**
+ * @class TimelineBuffer
+ * @brief Preallocated event buffer owned by a single generator thread.
+ * Every stride-th iteration is sampled. When the buffer fills up, every other sampled iteration
+ * is dropped and the stride doubles, so a run of any length fits the event budget.
+ */
+class TimelineBuffer {
+   private:
+    std::vector<TimelineEvent> events;
+    std::size_t count = 0;
+    uint64_t stride = 1;
+    uint64_t iteration = 0;
+    bool sampled = false;
+    void decimate(void);
+
+   public:
+    std::string label;
+    uint64_t tid;
+
+    /**
+     * @param label Thread name shown by the trace viewer.
+     * @param tid Track id, hw id of the generator.
+     * @param capacity Maximum number of events kept.
+     */
+    TimelineBuffer(const std::string& label, uint64_t tid, std::size_t capacity);
+
+    /**
+     * @brief Starts a new iteration.
+     * @return true if the iteration is sampled and its spans should be recorded.
+     */
+    bool begin_iteration(void);
+
+    /**
+     * @return true if the current iteration is sampled.
+     */
+    bool is_sampled(void) const { return this->sampled; }
+
+    /**
+     * @brief Records a span of the current iteration.
+     */
+    void record(TimelineSpan span, uint64_t begin_ns, uint64_t end_ns, uint64_t value = 0);
+
+    /**
+     * @return Events kept so far, oldest first.
+     */
+    std::vector<TimelineEvent> get_events(void) const;
+};
+
+/**
+ * @class Timeline
+ * @brief Common clock of all buffers and Chrome/Perfetto trace JSON export.
+ */
+class Timeline {
+   public:
+    /**
+     * @return Nanoseconds since the first call, shared by every thread.
+     */
+    static uint64_t now(void);
+
+    /**
+     * @brief Writes every buffer as one track of a Chrome trace (chrome://tracing, ui.perfetto.dev).
+     * @return true if the file was written.
+     */
+    static bool write(const std::string& file, const std::vector<std::shared_ptr<TimelineBuffer>>& buffers);
+};